@@ -0,0 +1,201 @@
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "support/benchruns.hpp"
+#include "support/feedback.hpp"
+#include "support/localisation.hpp"
+
+#include "plugin.hpp"
+
+namespace po = boost::program_options;
+using MiniMC::Support::Bench::Run;
+
+namespace {
+
+  struct LocalOptions {
+    std::size_t runs = 1;
+    std::vector<std::string> variants;
+    std::string csv;
+    std::string json;
+    std::string baseline;
+    double threshold = 0.1;
+  };
+
+  LocalOptions locoptions;
+
+  /**
+   * The configurations to run: \p input itself if it is a
+   * configuration file, the configuration files below it if it is a
+   * directory, and otherwise the files listed in it, one per line
+   */
+  std::vector<std::string> collectConfigs (const std::string& input) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> res;
+    if (fs::is_directory (input)) {
+      for (auto& entry : fs::recursive_directory_iterator (input)) {
+	if (entry.is_regular_file () && entry.path ().extension () == ".ini")
+	  res.push_back (entry.path ().string ());
+      }
+      std::sort (res.begin (),res.end ());
+    }
+    else if (fs::path (input).extension () == ".ini") {
+      res.push_back (input);
+    }
+    else {
+      std::ifstream list (input);
+      std::string line;
+      while (std::getline (list,line)) {
+	if (line.size () && line[0] != '#')
+	  res.push_back (line);
+      }
+    }
+    return res;
+  }
+
+  std::vector<std::string> splitArguments (const std::string& str) {
+    std::vector<std::string> res;
+    std::stringstream stream (str);
+    std::string arg;
+    while (stream >> arg)
+      res.push_back (arg);
+    return res;
+  }
+
+  std::string exitName (int status) {
+    if (WIFSIGNALED (status))
+      return "Signal" + std::to_string (WTERMSIG (status));
+    switch (static_cast<MiniMC::Support::ExitCodes> (WEXITSTATUS (status))) {
+    case MiniMC::Support::ExitCodes::AllGood:
+      return "AllGood";
+    case MiniMC::Support::ExitCodes::RuntimeError:
+      return "RuntimeError";
+    case MiniMC::Support::ExitCodes::ConfigurationError:
+      return "ConfigurationError";
+    case MiniMC::Support::ExitCodes::UnexpectedResult:
+      return "UnexpectedResult";
+    default:
+      return "Exit" + std::to_string (WEXITSTATUS (status));
+    }
+  }
+
+  /**
+   * Run this executable on \p config in a child process. The child
+   * writes its final exploration statistics, and the verification
+   * result of the mc command, to a temporary file. Runs without a
+   * result (the enum command, or a run that failed) record how the
+   * process ended instead.
+   */
+  Run runConfig (const std::string& config, const std::string& variant, std::size_t run) {
+    Run res {.config = config, .variant = variant, .run = run};
+    auto stats = std::filesystem::temp_directory_path () / ("minimc-bench-" + std::to_string (getpid ()) + ".json");
+    std::filesystem::remove (stats);
+
+    std::vector<std::string> args {"minimc",
+				   "--config",config,
+				   "--mc.stats.interval=0","--mc.stats.out=" + stats.string (),
+				   "--enum.stats.interval=0","--enum.stats.out=" + stats.string ()};
+    for (auto& arg : splitArguments (variant))
+      args.push_back (arg);
+    std::vector<char*> argv;
+    for (auto& arg : args)
+      argv.push_back (arg.data ());
+    argv.push_back (nullptr);
+
+    auto start = std::chrono::steady_clock::now ();
+    auto pid = fork ();
+    if (pid == 0) {
+      auto null = open ("/dev/null",O_WRONLY);
+      dup2 (null,STDOUT_FILENO);
+      dup2 (null,STDERR_FILENO);
+      execv ("/proc/self/exe",argv.data ());
+      _exit (static_cast<int> (MiniMC::Support::ExitCodes::RuntimeError));
+    }
+    if (pid < 0)
+      throw MiniMC::Support::Exception ("Could not start a benchmark run");
+
+    int status = 0;
+    struct rusage usage;
+    wait4 (pid,&status,0,&usage);
+    res.wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    res.peakRSS = usage.ru_maxrss;
+    std::stringstream json;
+    if (std::ifstream is (stats); is)
+      json << is.rdbuf ();
+    res.result = MiniMC::Support::Bench::readString (json.str (),"result");
+    if (res.result.empty ())
+      res.result = exitName (status);
+    res.states = MiniMC::Support::Bench::readStatistic (json.str (),"explored");
+    std::filesystem::remove (stats);
+    return res;
+  }
+
+  void addOptions (po::options_description& op,MiniMC::Algorithms::SetupOptions&) {
+    po::options_description desc("Bench Options");
+    desc.add_options ()
+      ("bench.runs",po::value<std::size_t> (&locoptions.runs)->default_value (1),"Number of runs of each configuration")
+      ("bench.variant",po::value<std::vector<std::string>> (&locoptions.variants),"Extra options to run every configuration with, e.g. \"--cpa=2\". May be given several times")
+      ("bench.csv",po::value<std::string> (&locoptions.csv),"Write the runs as CSV to this file")
+      ("bench.json",po::value<std::string> (&locoptions.json),"Write the runs as JSON to this file")
+      ("bench.baseline",po::value<std::string> (&locoptions.baseline),"CSV of earlier runs to compare against")
+      ("bench.threshold",po::value<double> (&locoptions.threshold)->default_value (0.1),"Relative growth of wall time or peak memory reported as regression")
+      ;
+    op.add (desc);
+  }
+
+}
+
+MiniMC::Support::ExitCodes bench_main (MiniMC::Model::Program_ptr&, MiniMC::Algorithms::SetupOptions&) {
+  auto& mess = MiniMC::Support::getMessager ();
+  auto configs = collectConfigs (getInputFile ());
+  if (configs.empty ()) {
+    mess.error (MiniMC::Support::Localiser ("No configurations found in '%1%'").format (getInputFile ()));
+    return MiniMC::Support::ExitCodes::ConfigurationError;
+  }
+  auto variants = locoptions.variants;
+  if (variants.empty ())
+    variants.push_back ("");
+
+  std::vector<Run> runs;
+  for (auto& config : configs) {
+    for (auto& variant : variants) {
+      for (std::size_t i = 0; i < locoptions.runs; ++i) {
+	runs.push_back (runConfig (config,variant,i));
+	auto& r = runs.back ();
+	mess.message (MiniMC::Support::Localiser ("%1% run %2%: %3%, %4% states, %5%s, %6% KB").format (MiniMC::Support::Bench::key (config,variant),i,r.result,r.states,r.wall,r.peakRSS));
+      }
+    }
+  }
+
+  if (locoptions.csv.size ()) {
+    std::ofstream os (locoptions.csv);
+    MiniMC::Support::Bench::writeCSV (os,runs);
+  }
+  if (locoptions.json.size ()) {
+    std::ofstream os (locoptions.json);
+    MiniMC::Support::Bench::writeJSON (os,runs);
+  }
+  if (locoptions.baseline.size ()) {
+    std::ifstream is (locoptions.baseline);
+    if (!is) {
+      mess.error (MiniMC::Support::Localiser ("Could not read baseline '%1%'").format (locoptions.baseline));
+      return MiniMC::Support::ExitCodes::ConfigurationError;
+    }
+    auto regressions = MiniMC::Support::Bench::compare (runs,MiniMC::Support::Bench::readCSV (is),locoptions.threshold,mess);
+    mess.message (MiniMC::Support::Localiser ("%1% regressions against the baseline").format (regressions));
+    if (regressions)
+      return MiniMC::Support::ExitCodes::UnexpectedResult;
+  }
+  return MiniMC::Support::ExitCodes::AllGood;
+}
+
+static CommandRegistrar bench_reg ("bench",bench_main,"Run the configuration files of INPUT (a .ini file, a directory, or a list of files) and record states explored, wall time, peak memory and result of each run. The configurations of tests/programs are generated into the build tree.",addOptions,false);
@@ -22,10 +22,23 @@ namespace po = boost::program_options;
 
 namespace {
 
+  struct LocalOptions {
+    std::size_t threads = 1;
+    bool partialOrder = false;
+    std::size_t statsInterval = 10;
+    std::string statsOut;
+  };
+  
+  LocalOptions locoptions;
+  
   auto runAlgorithm (MiniMC::Model::Program& prgm, const MiniMC::Algorithms::SetupOptions sopt, MiniMC::CPA::CPA_ptr cpa ) {
     MiniMC::Support::Sequencer<MiniMC::Model::Program> seq;
     MiniMC::Algorithms::setupForAlgorithm (seq,sopt);
-    MiniMC::Algorithms::EnumStates algo(MiniMC::Algorithms::EnumStates::Options {.cpa = cpa});
+    MiniMC::Algorithms::EnumStates algo(MiniMC::Algorithms::EnumStates::Options {.cpa = cpa,
+										  .threads = locoptions.threads,
+										  .partialOrder = locoptions.partialOrder,
+										  .statsInterval = std::chrono::seconds (locoptions.statsInterval),
+										  .statsOut = locoptions.statsOut});
     if (seq.run (prgm)) {
       algo.run (prgm);
       return MiniMC::Support::ExitCodes::AllGood;
@@ -35,7 +48,14 @@ namespace {
 
   
   void addOptions (po::options_description& op,MiniMC::Algorithms::SetupOptions& sopt) {  
-    
+    po::options_description desc("Enum Options");
+    desc.add_options()
+      ("enum.threads",po::value<std::size_t> (&locoptions.threads)->default_value (1),"Number of threads used for the enumeration")
+      ("enum.por",po::bool_switch (&locoptions.partialOrder),"Use partial order reduction")
+      ("enum.stats.interval",po::value<std::size_t> (&locoptions.statsInterval)->default_value (10),"Seconds between progress reports (0 for none)")
+      ("enum.stats.out",po::value<std::string> (&locoptions.statsOut),"Write the final exploration statistics as JSON to this file")
+      ;
+    op.add(desc);
   }
 }
 MiniMC::Support::ExitCodes enum_main (MiniMC::Model::Program_ptr& prgm,   MiniMC::Algorithms::SetupOptions& sopt)  {
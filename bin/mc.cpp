@@ -10,11 +10,42 @@ namespace po = boost::program_options;
 
 namespace {
   
-  MiniMC::Support::ExitCodes runAlgorithm (MiniMC::Model::Program& prgm,  const MiniMC::Algorithms::SetupOptions sopt, MiniMC::Algorithms::Reachability::ReachabilityResult expected ) {
+  struct LocalOptions {
+    MiniMC::Algorithms::Reachability::ReachabilityResult expect;	
+    std::size_t threads = 1;
+    bool partialOrder = false;
+    bool symmetry = false;
+    MiniMC::Algorithms::SearchStrategy search = MiniMC::Algorithms::SearchStrategy::DepthFirst;
+    std::string checkpoint;
+    std::size_t checkpointInterval = 1800;
+    std::string resume;
+    std::size_t statsInterval = 10;
+    std::string statsOut;
+    std::size_t timeBudget = 0;
+    std::size_t memoryBudget = 0;
+    std::size_t stateBudget = 0;
+    MiniMC::Algorithms::Restarts restarts;
+  };
+  
+  MiniMC::Support::ExitCodes runAlgorithm (MiniMC::Model::Program& prgm,  const MiniMC::Algorithms::SetupOptions sopt, const LocalOptions& opt) {
     using algorithm = MiniMC::Algorithms::Reachability;
     MiniMC::Support::Sequencer<MiniMC::Model::Program> seq;
     MiniMC::Algorithms::setupForAlgorithm (seq,sopt);
-    algorithm algo(typename algorithm::Options {.cpa = createUserDefinedCPA (CPASelector::LocationConcrete)});
+    algorithm algo(typename algorithm::Options {.cpa = createUserDefinedCPA (CPASelector::LocationConcrete),
+						 .threads = opt.threads,
+						 .partialOrder = opt.partialOrder,
+						 .symmetry = opt.symmetry,
+						 .search = opt.search,
+						 .checkpoint = opt.checkpoint,
+						 .checkpointInterval = std::chrono::seconds (opt.checkpointInterval),
+						 .resume = opt.resume,
+						 .setup = MiniMC::Algorithms::setupHash (sopt),
+						 .statsInterval = std::chrono::seconds (opt.statsInterval),
+						 .statsOut = opt.statsOut,
+						 .budget = {.time = std::chrono::seconds (opt.timeBudget),
+							    .memory = opt.memoryBudget * 1024 * 1024,
+							    .states = opt.stateBudget},
+						 .restarts = opt.restarts});
     if (seq.run (prgm)) {
       if (algo.run (prgm) == MiniMC::Algorithms::Result::Success) {
 	
@@ -22,13 +53,17 @@ namespace {
 	if (analysisres.result == MiniMC::Algorithms::Reachability::ReachabilityResult::Found) {
 	  MiniMC::Support::getMessager ().message (MiniMC::Support::Localiser ("Found Violation").format ());
 	}
+
+	else if (analysisres.result == MiniMC::Algorithms::Reachability::ReachabilityResult::Inconclusive) {
+	  MiniMC::Support::getMessager ().message (MiniMC::Support::Localiser ("Inconclusive").format());
+	}
 	
 	else if (analysisres.result == MiniMC::Algorithms::Reachability::ReachabilityResult::NotFound) {
 	  MiniMC::Support::getMessager ().message (MiniMC::Support::Localiser ("No Violation Found").format());
 	  
 	}
 	
-	if (algo.getAnalysisResult ().result == expected) {
+	if (algo.getAnalysisResult ().result == opt.expect) {
 	  return MiniMC::Support::ExitCodes::AllGood;
 	}
 	else {
@@ -43,10 +78,6 @@ namespace {
   }
 
   
-  struct LocalOptions {
-    MiniMC::Algorithms::Reachability::ReachabilityResult expect;	
-  };
-  
   LocalOptions locoptions;
   
   
@@ -68,12 +99,51 @@ namespace {
       }
     };
 
+    auto setSearch = [&] (int val) {
+      switch (val) {
+      case 1:
+	locoptions.search = MiniMC::Algorithms::SearchStrategy::BreadthFirst;
+	break;
+      case 2:
+	locoptions.search = MiniMC::Algorithms::SearchStrategy::AssertDistance;
+	break;
+      case 3:
+	locoptions.search = MiniMC::Algorithms::SearchStrategy::Random;
+	break;
+      case 4:
+	locoptions.search = MiniMC::Algorithms::SearchStrategy::RandomRestart;
+	break;
+      default:
+	locoptions.search = MiniMC::Algorithms::SearchStrategy::DepthFirst;
+	break;
+      }
+    };
+
     po::options_description desc("MC Options");
     desc.add_options()
       ("mc.expect",po::value<int> ()->default_value (0)->notifier (setExpected),"Set the expected verification result\n"
        "\t 1 AssertViolation\n"
        "\t 2 Inconclusive\n"
        "\t 0 NoViolation\n")
+      ("mc.threads",po::value<std::size_t> (&locoptions.threads)->default_value (1),"Number of threads used for the search")
+      ("mc.por",po::bool_switch (&locoptions.partialOrder),"Use partial order reduction")
+      ("mc.symmetry",po::bool_switch (&locoptions.symmetry),"Use symmetry reduction for processes started at the same function")
+      ("mc.search",po::value<int> ()->default_value (0)->notifier (setSearch),"Search strategy\n"
+       "\t 0 Depth first\n"
+       "\t 1 Breadth first\n"
+       "\t 2 Closest to assert violation first\n"
+       "\t 3 Random\n"
+       "\t 4 Random with restarts\n")
+      ("mc.restart.bound",po::value<std::size_t> (&locoptions.restarts.bound)->default_value (10000),"States explored before a random restart")
+      ("mc.restart.count",po::value<std::size_t> (&locoptions.restarts.count)->default_value (100),"Random restarts before the search gives up as Inconclusive")
+      ("mc.checkpoint",po::value<std::string> (&locoptions.checkpoint),"Periodically write the state of the search to this file")
+      ("mc.checkpoint.interval",po::value<std::size_t> (&locoptions.checkpointInterval)->default_value (1800),"Seconds between checkpoints")
+      ("resume",po::value<std::string> (&locoptions.resume),"Continue the search from a checkpoint")
+      ("mc.stats.interval",po::value<std::size_t> (&locoptions.statsInterval)->default_value (10),"Seconds between progress reports (0 for none)")
+      ("mc.stats.out",po::value<std::string> (&locoptions.statsOut),"Write the final exploration statistics as JSON to this file")
+      ("mc.budget.time",po::value<std::size_t> (&locoptions.timeBudget)->default_value (0),"Stop the search as Inconclusive after this many seconds (0 for no limit)")
+      ("mc.budget.memory",po::value<std::size_t> (&locoptions.memoryBudget)->default_value (0),"Stop the search as Inconclusive when the process uses this many MB (0 for no limit)")
+      ("mc.budget.states",po::value<std::size_t> (&locoptions.stateBudget)->default_value (0),"Stop the search as Inconclusive after this many states (0 for no limit)")
 	  
       ;
 
@@ -86,7 +156,7 @@ namespace {
 
 MiniMC::Support::ExitCodes mc_main (MiniMC::Model::Program_ptr& prgm,   MiniMC::Algorithms::SetupOptions& sopt) {
   sopt.expandNonDet = true;  
-  return runAlgorithm (*prgm,sopt,locoptions.expect);
+  return runAlgorithm (*prgm,sopt,locoptions);
 }
 
 static CommandRegistrar mc_reg ("mc",mc_main,"Check whether it is possible to reach an assert violation. Classic reachability analysis. ",addOptions);
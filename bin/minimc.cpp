@@ -2,6 +2,7 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <fstream>
 #include <boost/program_options.hpp>
 #include "support/localisation.hpp"
 #include "support/smt.hpp"
@@ -9,6 +10,7 @@
 #include "loaders/loader.hpp"
 #include "algorithms/algorithm.hpp"
 #include "support/timing.hpp"
+#include "support/random.hpp"
 #include "plugin.hpp"
 
 #include "cpa/location.hpp"
@@ -17,6 +19,7 @@
 #endif
 #include "cpa/concrete.hpp"
 #include "cpa/compound.hpp"
+#include "cpa/approximate.hpp"
 
 
 namespace po = boost::program_options;
@@ -28,40 +31,69 @@ void printBanner (std::ostream& os) {
 }
 
 CPASelector selectedCPA = CPASelector::Automatic;
+MiniMC::CPA::StorageMode storageMode = MiniMC::CPA::StorageMode::Exact;
+std::size_t storageMemory = 1024;
+std::string storageDir;
+std::string profileOut;
+std::string profileTrace;
+std::string input;
 
-MiniMC::CPA::CPA_ptr createUserDefinedCPA (CPASelector defaultSelector) {      
-  assert(defaultSelector != CPASelector::Automatic);
-  CPASelector sel = (selectedCPA != CPASelector::Automatic) ? selectedCPA : defaultSelector;
-  switch (sel) {
+namespace {
+  void writeProfile () {
+    if (profileOut.size ()) {
+      std::ofstream os (profileOut);
+      MiniMC::Support::Profiler::get ().writeJSON (os);
+    }
+    if (profileTrace.size ()) {
+      std::ofstream os (profileTrace);
+      MiniMC::Support::Profiler::get ().writeTrace (os);
+    }
+  }
+  
+  MiniMC::CPA::CPA_ptr createSelectedCPA (CPASelector sel) {
+    switch (sel) {
 #ifdef MINIMC_SYMBOLIC
   
-  case CPASelector::LocationPathformula:
-    return std::make_shared<MiniMC::CPA::Compounds::CPA> (std::initializer_list<MiniMC::CPA::CPA_ptr>({
-	  std::make_shared<MiniMC::CPA::Location::CPA> (),
-	  std::make_shared<MiniMC::CPA::PathFormula::CPA> ()}));
-    break;
+    case CPASelector::LocationPathformula:
+      return std::make_shared<MiniMC::CPA::Compounds::CPA> (std::initializer_list<MiniMC::CPA::CPA_ptr>({
+	    std::make_shared<MiniMC::CPA::Location::CPA> (),
+	    std::make_shared<MiniMC::CPA::PathFormula::CPA> ()}));
+      break;
     
 #endif
-  case CPASelector::LocationConcrete:
-    return std::make_shared<MiniMC::CPA::Compounds::CPA> (std::initializer_list<MiniMC::CPA::CPA_ptr>({
-	  std::make_shared<MiniMC::CPA::Location::CPA> (),
-	  std::make_shared<MiniMC::CPA::Concrete::CPA> ()}));
-    break;
+    case CPASelector::LocationConcrete:
+      return std::make_shared<MiniMC::CPA::Compounds::Compound<1,MiniMC::CPA::Location::CPA,
+								MiniMC::CPA::Concrete::CPA>> ();
+      break;
     
-  case CPASelector::Location:
-  default:
+    case CPASelector::Location:
+    default:
       
-    return std::make_shared<MiniMC::CPA::Location::CPA> ();
-    //res = runAlgorithm<MiniMC::CPA::Location::CPADef> (*prgm,sopt,locoptions.filter);
-    break;
+      return std::make_shared<MiniMC::CPA::Location::CPA> ();
+      //res = runAlgorithm<MiniMC::CPA::Location::CPADef> (*prgm,sopt,locoptions.filter);
+      break;
+    }
+  }
+}
+
+const std::string& getInputFile () {
+  return input;
+}
+
+MiniMC::CPA::CPA_ptr createUserDefinedCPA (CPASelector defaultSelector) {      
+  assert(defaultSelector != CPASelector::Automatic);
+  CPASelector sel = (selectedCPA != CPASelector::Automatic) ? selectedCPA : defaultSelector;
+  auto cpa = createSelectedCPA (sel);
+  if (storageMode != MiniMC::CPA::StorageMode::Exact) {
+    cpa = std::make_shared<MiniMC::CPA::ApproximateStorageCPA> (cpa,storageMode,storageMemory*1024*1024,storageDir);
   }
+  return cpa;
 }
 
 
 
 int main (int argc,char* argv[]) {
 
-  std::string input;
   std::string subcommand;
   std::vector<std::string> subargs;
   MiniMC::Support::setMessager (MiniMC::Support::MessagerType::Terminal);
@@ -79,6 +111,27 @@ int main (int argc,char* argv[]) {
 						 
 					   }
 					 };
+  auto updateStorage = [&] (int val) {
+    switch (val) {
+    case 1:
+      storageMode = MiniMC::CPA::StorageMode::HashCompaction;
+      break;
+    case 2:
+      storageMode = MiniMC::CPA::StorageMode::BitState;
+      break;
+    case 3:
+      storageMode = MiniMC::CPA::StorageMode::External;
+      break;
+    case 4:
+      storageMode = MiniMC::CPA::StorageMode::Collapse;
+      break;
+    case 0:
+    default:
+      storageMode = MiniMC::CPA::StorageMode::Exact;
+      break;
+    }
+  };
+  
   po::options_description hidden("Hidden");
   po::options_description general("General Options");
   
@@ -141,6 +194,18 @@ int main (int argc,char* argv[]) {
      "\t 3: PathFormula\n"
 #endif
      )
+    ("storage",po::value<int>()->default_value(0)->notifier(updateStorage), "State storage (approximate modes may miss states)\n"
+     "\t 0: Exact\n"
+     "\t 1: Hash compaction\n"
+     "\t 2: Bitstate\n"
+     "\t 3: External (fingerprints and search layers on disk)\n"
+     "\t 4: Collapse (exact, equal parts of states are shared; saves far less than index tuples would, single thread only)\n"
+     )
+    ("storage.memory",po::value<std::size_t> (&storageMemory)->default_value(1024),"Memory budget in MB for approximate and external storage")
+    ("storage.dir",po::value<std::string> (&storageDir),"Scratch directory for external storage (default: system temporary directory)")
+    ("seed",po::value<std::uint64_t> ()->notifier(MiniMC::Support::setSeed),"Seed for random choices (drawn at random if not given)")
+    ("profile-out",po::value<std::string> (&profileOut),"Write the wall and CPU time of each phase as JSON to this file")
+    ("profile-trace",po::value<std::string> (&profileTrace),"Write a Chrome trace-event timeline of the phases to this file")
 
     ;
   
@@ -215,6 +280,10 @@ int main (int argc,char* argv[]) {
 	  }
 	}
 	
+	if (profileOut.size () || profileTrace.size ()) {
+	  MiniMC::Support::Profiler::get ().enable (profileTrace.size ());
+	}
+	
 	if (!vm.count ("command")) {
 	  printHelp ();
 	  return static_cast<int>(MiniMC::Support::ExitCodes::ConfigurationError);
@@ -226,13 +295,24 @@ int main (int argc,char* argv[]) {
 
 	  return static_cast<int>(MiniMC::Support::ExitCodes::ConfigurationError);
 	}
+
+	if (isCommand (subcommand) && !commandNeedsProgram (subcommand)) {
+	  MiniMC::Model::Program_ptr none;
+	  auto res = getCommand(subcommand) (none,soptions);
+	  writeProfile ();
+	  return static_cast<int>(res);
+	}
 	
 	//Load Program
 	MiniMC::Model::TypeFactory_ptr tfac = std::make_shared<MiniMC::Model::TypeFactory64> ();
 	MiniMC::Model::ConstantFactory_ptr cfac = std::make_shared<MiniMC::Model::ConstantFactory64> ();
-	MiniMC::Model::Program_ptr prgm = MiniMC::Loaders::loadFromFile<MiniMC::Loaders::Type::LLVM> (input, typename MiniMC::Loaders::OptionsLoad<MiniMC::Loaders::Type::LLVM>::Opt {.tfactory = tfac,
-																																												  .cfactory =cfac}
-	  );
+	MiniMC::Model::Program_ptr prgm;
+	{
+	  MiniMC::Support::Phase phase ("LLVM loading");
+	  prgm = MiniMC::Loaders::loadFromFile<MiniMC::Loaders::Type::LLVM> (input, typename MiniMC::Loaders::OptionsLoad<MiniMC::Loaders::Type::LLVM>::Opt {.tfactory = tfac,
+																																				  .cfactory =cfac}
+		);
+	}
 	
   assert(prgm);
   
@@ -260,7 +340,9 @@ int main (int argc,char* argv[]) {
   
   if (isCommand (subcommand)) {
 	
-	return static_cast<int>(getCommand(subcommand) (prgm,soptions));
+	auto res = getCommand(subcommand) (prgm,soptions);
+	writeProfile ();
+	return static_cast<int>(res);
   }
   
   else {
@@ -18,6 +18,10 @@ bool isCommand (const std::string& s) {
   return getMap().count (s);
 }
 
+bool commandNeedsProgram (const std::string& s) {
+  return getMap().at(s)->getNeedsProgram ();
+}
+
 subcommandfunc getCommand (const std::string& s) {
   return getMap().at(s)->getFunction ();
 }
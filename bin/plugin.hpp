@@ -27,26 +27,33 @@ MiniMC::CPA::CPA_ptr createUserDefinedCPA (CPASelector defaultSelector);
 struct CommandRegistrar;
 void registerCommand (const std::string&, CommandRegistrar&);
 bool isCommand (const std::string&);
+bool commandNeedsProgram (const std::string&);
 subcommandfunc getCommand (const std::string&);
 options_func getOptionsFunc (const std::string&);
 std::unordered_map<std::string,std::string> getCommandNameAndDescr ();
 
 struct CommandRegistrar {
-  CommandRegistrar (const std::string& s,subcommandfunc func, const std::string& desc, options_func ofunc) : s(s),func(func),desc(desc),opt(ofunc) {
+  CommandRegistrar (const std::string& s,subcommandfunc func, const std::string& desc, options_func ofunc, bool needsProgram = true) : s(s),func(func),desc(desc),opt(ofunc),needsProgram(needsProgram) {
 	registerCommand (s,*this);
   }
   std::string getName () const {return s;}
   std::string getDescritpion () const { return desc;}
   subcommandfunc getFunction () const {return func;}
   options_func getOptions () const {return opt;}
+  /** Commands that do not need a program get a null Program_ptr */
+  bool getNeedsProgram () const {return needsProgram;}
   
 private:
   std::string s;
   subcommandfunc func;
   std::string desc;
   options_func opt;
+  bool needsProgram;
 };
 
+/** @return the input file given on the command line */
+const std::string& getInputFile ();
+
 
 bool parseOptionsAddHelp (boost::program_options::variables_map& map, boost::program_options::options_description& opt, std::vector<std::string>& params);
 
@@ -33,6 +33,7 @@ namespace {
 
   struct LocalOptions {
 	std::size_t length;
+	std::size_t threads = 1;
 	Algo algo = Algo::Fixed;
 	MiniMC::Algorithms::ProbaChecker<MiniMC::Support::Statistical::ClopperPearson>::Options clopperOpt;
 	MiniMC::Algorithms::ProbaChecker<MiniMC::Support::Statistical::FixedEffort>::Options fixedOpt;
@@ -60,6 +61,7 @@ namespace {
 	   "\t 1 Clopper Pearson\n"
 	   )
 	  ("smc.length",po::value<std::size_t> (&locoptions.length),"Length")
+	  ("smc.threads",po::value<std::size_t> (&locoptions.threads)->default_value (1),"Number of threads generating traces")
 	  ;
     
   
@@ -92,6 +94,8 @@ MiniMC::Support::ExitCodes smc_main (MiniMC::Model::Program_ptr& prgm,   MiniMC:
 
   locoptions.clopperOpt.len = locoptions.length;
   locoptions.fixedOpt.len = locoptions.length;
+  locoptions.clopperOpt.threads = locoptions.threads;
+  locoptions.fixedOpt.threads = locoptions.threads;
   MiniMC::Support::ExitCodes res;
   switch (locoptions.algo) {
   case Algo::Fixed:
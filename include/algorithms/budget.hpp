@@ -0,0 +1,99 @@
+/**
+ * @file   budget.hpp
+ *
+ * @brief  Resource limits of a search
+ *
+ *
+ */
+#ifndef _BUDGET__
+#define _BUDGET__
+
+#include "algorithms/telemetry.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ostream>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    /**
+     * Limits of a search. A limit of 0 is no limit.
+     */
+    struct Budget {
+      std::chrono::seconds time{0}; /**< Wall time of the search */
+      std::size_t memory = 0;       /**< Resident memory of the process in bytes */
+      std::size_t states = 0;       /**< States added to the waiting list */
+
+      bool unlimited() const { return !time.count() && !memory && !states; }
+    };
+
+    enum class BudgetExceeded {
+      None,
+      Time,
+      Memory,
+      States
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, BudgetExceeded b) {
+      switch (b) {
+        case BudgetExceeded::Time:
+          return os << "time";
+        case BudgetExceeded::Memory:
+          return os << "memory";
+        case BudgetExceeded::States:
+          return os << "states";
+        default:
+          return os << "none";
+      }
+    }
+
+    /**
+     * Enforces a Budget. The searches compare their state count on
+     * every step, and look at the clock and the resident memory only
+     * every few hundred steps. Once a limit is exceeded the guard
+     * stays exceeded. May be used from several threads.
+     */
+    class BudgetGuard {
+    public:
+      BudgetGuard(const Budget& budget) : budget(budget),
+                                          deadline(std::chrono::steady_clock::now() + budget.time) {}
+
+      /**
+       * @return true if \p states exceeds the state limit
+       */
+      bool checkStates(std::size_t states) {
+        if (budget.states && states >= budget.states)
+          exceed(BudgetExceeded::States);
+        return exceeded() != BudgetExceeded::None;
+      }
+
+      /**
+       * @return true if the time or memory limit is exceeded
+       */
+      bool checkResources() {
+        if (budget.time.count() && std::chrono::steady_clock::now() >= deadline)
+          exceed(BudgetExceeded::Time);
+        else if (budget.memory && residentMemory() >= budget.memory)
+          exceed(BudgetExceeded::Memory);
+        return exceeded() != BudgetExceeded::None;
+      }
+
+      BudgetExceeded exceeded() const { return reason.load(std::memory_order_relaxed); }
+
+    private:
+      void exceed(BudgetExceeded r) {
+        auto expected = BudgetExceeded::None;
+        reason.compare_exchange_strong(expected, r, std::memory_order_relaxed);
+      }
+
+      Budget budget;
+      std::chrono::steady_clock::time_point deadline;
+      std::atomic<BudgetExceeded> reason = BudgetExceeded::None;
+    };
+
+    using BudgetGuard_ptr = std::shared_ptr<BudgetGuard>;
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
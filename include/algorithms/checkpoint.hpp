@@ -0,0 +1,228 @@
+/**
+ * @file   checkpoint.hpp
+ *
+ * @brief  Checkpoint files of a running exploration
+ *
+ *
+ */
+#ifndef _CHECKPOINT__
+#define _CHECKPOINT__
+
+#include "algorithms/algorithm.hpp"
+#include "cpa/approximate.hpp"
+#include "cpa/interface.hpp"
+#include "hash/hashing.hpp"
+#include "support/exceptions.hpp"
+#include "support/serialize.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    /**
+     * Identifies what a checkpoint was taken of. A checkpoint can only
+     * be resumed with an equal header.
+     */
+    struct CheckpointHeader {
+      MiniMC::Hash::hash_t program = 0;
+      MiniMC::Hash::hash_t setup = 0;
+      MiniMC::Hash::hash_t search = 0;
+
+      bool operator==(const CheckpointHeader& oth) const { return program == oth.program && setup == oth.setup && search == oth.search; }
+      bool operator!=(const CheckpointHeader& oth) const { return !(*this == oth); }
+    };
+
+    /**
+     * @return hash of the textual form of the functions, locations,
+     * edges, globals, initialisation and entry points of \p prgm
+     */
+    inline MiniMC::Hash::hash_t programHash(const MiniMC::Model::Program& prgm) {
+      std::stringstream str;
+      for (auto& var : prgm.getGlobals()->getVariables())
+        str << *var << ";";
+      str << prgm.getInitialisation().instr << "\n";
+      for (auto& func : prgm.getFunctions()) {
+        auto& cfg = func->getCFG();
+        str << func->getID() << " " << func->getName() << "\n";
+        for (auto& loc : cfg->getLocations())
+          str << loc->getID() << " " << loc->getInfo() << "\n";
+        for (auto& edge : cfg->getEdges())
+          str << edge->getFrom()->getID() << "->" << edge->getTo()->getID() << " " << *edge << "\n";
+      }
+      for (auto& entry : prgm.getEntryPoints())
+        str << entry->getID() << ";";
+      auto text = str.str();
+      return MiniMC::Hash::Hash(text.data(), text.size(), 0);
+    }
+
+    inline MiniMC::Hash::hash_t setupHash(const SetupOptions& sopt) {
+      MiniMC::uint64_t buf[] = {static_cast<MiniMC::uint64_t>(sopt.reduction),
+                                sopt.isConcurrent,
+                                sopt.expandNonDet,
+                                sopt.replaceNonDetUniform,
+                                sopt.simplifyCFG,
+                                sopt.replaceSub,
+                                sopt.splitCMPS,
+                                sopt.foldConstants,
+                                sopt.convergencePoints,
+                                sopt.removeAllocs,
+                                sopt.replacememnodet,
+                                sopt.removephi,
+                                sopt.inlinefunctions,
+                                sopt.unrollLoops};
+      return MiniMC::Hash::Hash(buf, std::size(buf), 0);
+    }
+
+    /**
+     * @return hash of the search options that change which States are
+     * stored and how: the CPA, its storage mode and whether symmetry
+     * and partial order reduction are used
+     */
+    inline MiniMC::Hash::hash_t searchHash(const MiniMC::CPA::ICPA& cpa, bool symmetry, bool partialOrder) {
+      auto storage = MiniMC::CPA::StorageMode::Exact;
+      const MiniMC::CPA::ICPA* inner = &cpa;
+      if (auto approx = dynamic_cast<const MiniMC::CPA::ApproximateStorageCPA*>(&cpa)) {
+        storage = approx->getMode();
+        inner = approx->getCPA().get();
+      }
+      std::stringstream str;
+      str << typeid(*inner).name() << ";" << static_cast<int>(storage) << ";" << symmetry << ";" << partialOrder;
+      auto text = str.str();
+      return MiniMC::Hash::Hash(text.data(), text.size(), 0);
+    }
+
+    /**
+     * A checkpoint file read into memory. The file starts with a
+     * magic string, the checkpoint and State format versions and the
+     * header; the rest is written and read by the SimulationManager.
+     */
+    struct Checkpoint {
+      static constexpr char magic[8] = {'M', 'i', 'n', 'i', 'M', 'C', 'C', 'P'};
+      static constexpr MiniMC::uint8_t version = 2;
+
+      CheckpointHeader header;
+      std::vector<MiniMC::uint8_t> data;
+      std::size_t bodyStart = 0;
+
+      /**
+       * @return Reader positioned at the body of the checkpoint
+       */
+      MiniMC::Support::Reader body() const { return MiniMC::Support::Reader(data.data() + bodyStart, data.size() - bodyStart); }
+
+      static void writeHeader(MiniMC::Support::Writer& writer, const CheckpointHeader& header) {
+        writer.bytes(reinterpret_cast<const MiniMC::uint8_t*>(magic), sizeof(magic));
+        writer.byte(version);
+        writer.byte(MiniMC::CPA::serializationVersion);
+        writer.varint(header.program);
+        writer.varint(header.setup);
+        writer.varint(header.search);
+      }
+
+      static Checkpoint read(const std::filesystem::path& file) {
+        std::ifstream is(file, std::ios::binary);
+        if (!is)
+          throw MiniMC::Support::Exception("Cannot open checkpoint " + file.string());
+        Checkpoint res;
+        res.data.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+
+        MiniMC::Support::Reader reader(res.data);
+        if (!std::equal(magic, magic + sizeof(magic), reader.bytes(sizeof(magic))))
+          throw MiniMC::Support::SerializationError(file.string() + " is not a checkpoint");
+        if (reader.byte() != version || reader.byte() != MiniMC::CPA::serializationVersion)
+          throw MiniMC::Support::SerializationError("Checkpoint " + file.string() + " was written by another version");
+        res.header.program = reader.varint();
+        res.header.setup = reader.varint();
+        res.header.search = reader.varint();
+        res.bodyStart = res.data.size() - reader.remaining();
+        return res;
+      }
+    };
+
+    /**
+     * Decides when the next checkpoint is due and writes checkpoints
+     * on a background thread, so the search only stops to serialize
+     * its States. A checkpoint is written to a temporary file that
+     * replaces \p file once it is complete, so a crash while writing
+     * leaves the previous checkpoint intact.
+     */
+    class Checkpointer {
+    public:
+      Checkpointer(const std::filesystem::path& file, const CheckpointHeader& header, std::chrono::seconds interval) : file(file),
+                                                                                                                       header(header),
+                                                                                                                       interval(interval),
+                                                                                                                       next(std::chrono::steady_clock::now() + interval) {}
+
+      ~Checkpointer() { wait(); }
+
+      bool due() const { return std::chrono::steady_clock::now() >= next; }
+
+      /**
+       * Write a checkpoint with \p body. Waits for the previous
+       * checkpoint to be written first.
+       */
+      void save(std::vector<MiniMC::uint8_t>&& body) {
+        wait();
+        writer = std::thread([this, body = std::move(body)]() { write(body); });
+        next = std::chrono::steady_clock::now() + interval;
+      }
+
+      /**
+       * Wait for the checkpoint being written
+       */
+      void wait() {
+        if (writer.joinable())
+          writer.join();
+      }
+
+      const CheckpointHeader& getHeader() const { return header; }
+      std::size_t getWritten() const { return written; }
+      std::size_t getFailed() const { return failed; }
+
+    private:
+      void write(const std::vector<MiniMC::uint8_t>& body) {
+        std::vector<MiniMC::uint8_t> head;
+        MiniMC::Support::Writer headWriter(head);
+        Checkpoint::writeHeader(headWriter, header);
+
+        auto tmp = file;
+        tmp += ".tmp";
+        {
+          std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+          os.write(reinterpret_cast<const char*>(head.data()), head.size());
+          os.write(reinterpret_cast<const char*>(body.data()), body.size());
+          if (!os) {
+            failed++;
+            return;
+          }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, file, ec);
+        if (ec)
+          failed++;
+        else
+          written++;
+      }
+
+      std::filesystem::path file;
+      CheckpointHeader header;
+      std::chrono::seconds interval;
+      std::chrono::steady_clock::time_point next;
+      std::thread writer;
+      std::atomic<std::size_t> written = 0;
+      std::atomic<std::size_t> failed = 0;
+    };
+
+    using Checkpointer_ptr = std::shared_ptr<Checkpointer>;
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef _PRINTGRAPH__
-#define _PRINTGGRAPH__
+#ifndef _ENUMSTATES__
+#define _ENUMSTATES__
 
 #include "algorithms/algorithm.hpp"
 #include "algorithms/reachability.hpp"
@@ -9,6 +9,7 @@
 #include "support/exceptions.hpp"
 #include "support/feedback.hpp"
 #include "support/localisation.hpp"
+#include <chrono>
 #include <sstream>
 
 namespace MiniMC {
@@ -17,9 +18,18 @@ namespace MiniMC {
     public:
       struct Options {
         MiniMC::CPA::CPA_ptr cpa;
+        std::size_t threads = 1;
+        bool partialOrder = false;              /**< Use partial order reduction */
+        std::chrono::seconds statsInterval{10}; /**< Time between progress reports, 0 for none */
+        std::string statsOut;                   /**< File for the final statistics as JSON, empty for none */
       };
 
-      EnumStates(const Options& opt) : messager(MiniMC::Support::getMessager()), cpa(opt.cpa) {}
+      EnumStates(const Options& opt) : messager(MiniMC::Support::getMessager()),
+                                       cpa(opt.cpa),
+                                       threads(opt.threads),
+                                       partialOrder(opt.partialOrder),
+                                       statsInterval(opt.statsInterval),
+                                       statsOut(opt.statsOut) {}
       virtual Result run(const MiniMC::Model::Program& prgm) {
         if (!cpa->makeValidate()->validate(prgm, messager)) {
           return Result::Error;
@@ -27,6 +37,7 @@ namespace MiniMC {
         messager.message("Initiating EnumStates");
 
         auto progresser = messager.makeProgresser();
+        auto telemetry = std::make_shared<Telemetry>(statsInterval, [&progresser](const TelemetrySample& s) { progresser->progressMessage(formatSample(s)); });
         auto predicate = [](auto& b) { return false; };
         auto query = cpa->makeQuery();
         auto transfer = cpa->makeTransfer();
@@ -35,7 +46,14 @@ namespace MiniMC {
         MiniMC::Algorithms::SimulationManager simmanager(MiniMC::Algorithms::SimManagerOptions{
             .storer = cpa->makeStore(),
             .joiner = cpa->makeJoin(),
-            .transfer = cpa->makeTransfer()});
+            .transfer = cpa->makeTransfer(),
+            .threads = threads,
+            .por = partialOrder ? std::make_shared<PartialOrderReduction>(prgm) : nullptr,
+            .telemetry = telemetry,
+            .load = [query, &prgm](MiniMC::Support::Reader& reader) { return query->deserialize(reader, prgm); }});
+        if (threads > 1 && !simmanager.supportsParallel()) {
+          messager.warning("CPA or storage does not support parallel search. Using a single thread");
+        }
         simmanager.insert(initstate);
         simmanager.reachabilitySearch({.filter = [](const MiniMC::CPA::State_ptr& state) {
           return state->getConcretizer()->isFeasible() == MiniMC::CPA::Concretizer::Feasibility::Feasible;
@@ -43,12 +61,20 @@ namespace MiniMC {
 
         messager.message("Finished EnumStates");
         messager.message(MiniMC::Support::Localiser("Total Number of States %1%").format(simmanager.getPSize()));
+        reportTelemetry(messager, telemetry, statsOut);
+        reportThreadStatistics(messager, simmanager.getThreadStatistics());
+        reportStorage(messager, simmanager.getStorer());
+        reportPartialOrder(messager, simmanager.getPartialOrder());
         return Result::Success;
       }
 
     private:
       MiniMC::Support::Messager& messager;
       MiniMC::CPA::CPA_ptr cpa;
+      std::size_t threads;
+      bool partialOrder;
+      std::chrono::seconds statsInterval;
+      std::string statsOut;
     };
   } // namespace Algorithms
 } // namespace MiniMC
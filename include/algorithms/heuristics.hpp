@@ -0,0 +1,170 @@
+/**
+ * @file   heuristics.hpp
+ *
+ * @brief  Search strategies for the SimulationManager
+ *
+ *
+ */
+#ifndef _HEURISTICS__
+#define _HEURISTICS__
+
+#include "algorithms/simulationmanager.hpp"
+#include "algorithms/waitinglist.hpp"
+#include "model/cfg.hpp"
+#include "support/random.hpp"
+#include <deque>
+#include <limits>
+#include <unordered_map>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    enum class SearchStrategy {
+      DepthFirst,
+      BreadthFirst,
+      AssertDistance, /**< Best first on the CFG distance to an assert violation */
+      Random,         /**< Explore waiting States in random order */
+      RandomRestart   /**< Random order, starting over after a bounded number of States */
+    };
+
+    /**
+     * Number of edges from each Location to the nearest
+     * Location with the AssertViolated attribute in the same
+     * CFG. Computed by a backward breadth first search from those
+     * Locations.
+     */
+    class AssertDistance {
+    public:
+      static constexpr std::size_t unreachable = std::numeric_limits<std::size_t>::max();
+
+      AssertDistance(const MiniMC::Model::Program& prgm) {
+        std::deque<MiniMC::Model::Location*> queue;
+        for (auto& func : prgm.getFunctions()) {
+          for (auto& loc : func->getCFG()->getLocations()) {
+            if (loc->getInfo().is<MiniMC::Model::Attributes::AssertViolated>()) {
+              distances[loc.get()] = 0;
+              queue.push_back(loc.get());
+            }
+          }
+        }
+        while (queue.size()) {
+          auto loc = queue.front();
+          queue.pop_front();
+          auto dist = distances[loc] + 1;
+          for (auto it = loc->iebegin(); it != loc->ieend(); ++it) {
+            auto from = (*it)->getFrom().get().get();
+            if (!distances.count(from)) {
+              distances[from] = dist;
+              queue.push_back(from);
+            }
+          }
+        }
+      }
+
+      std::size_t distance(const MiniMC::Model::Location* loc) const {
+        auto it = distances.find(loc);
+        return it != distances.end() ? it->second : unreachable;
+      }
+
+      /**
+       * @return the distance of the process of \p state closest to an
+       * assert violation
+       */
+      std::size_t distance(const MiniMC::CPA::State& state) const {
+        std::size_t res = unreachable;
+        for (std::size_t i = 0; i < state.nbOfProcesses(); ++i)
+          res = std::min(res, distance(state.getLocation(i).get()));
+        return res;
+      }
+
+    private:
+      std::unordered_map<const MiniMC::Model::Location*, std::size_t> distances;
+    };
+
+    struct SearchSetup {
+      SearchOrder order;
+      WaitingList::PriorityFunction priority;
+    };
+
+    /**
+     * @return the waiting list order and priority implementing \p strategy for \p prgm
+     */
+    inline SearchSetup makeSearch(SearchStrategy strategy, const MiniMC::Model::Program& prgm) {
+      switch (strategy) {
+        case SearchStrategy::BreadthFirst:
+          return {SearchOrder::BreadthFirst, nullptr};
+        case SearchStrategy::AssertDistance: {
+          auto dist = std::make_shared<AssertDistance>(prgm);
+          return {SearchOrder::Priority, [dist](const MiniMC::CPA::State_ptr& s) -> std::int64_t {
+                    auto d = dist->distance(*s);
+                    return d == AssertDistance::unreachable ? std::numeric_limits<std::int64_t>::min() : -static_cast<std::int64_t>(d);
+                  }};
+        }
+        case SearchStrategy::Random:
+        case SearchStrategy::RandomRestart:
+          return {SearchOrder::Priority, [](const MiniMC::CPA::State_ptr&) {
+                    return MiniMC::Support::RandomNumber<>{}.uniform<std::int64_t>();
+                  }};
+        case SearchStrategy::DepthFirst:
+        default:
+          return {SearchOrder::DepthFirst, nullptr};
+      }
+    }
+
+    /**
+     * Bounds of SearchStrategy::RandomRestart
+     */
+    struct Restarts {
+      std::size_t bound = 10000; /**< States added to the waiting list before starting over */
+      std::size_t count = 100;   /**< Restarts before giving up */
+    };
+
+    struct RestartResult {
+      MiniMC::CPA::State_ptr found = nullptr;
+      bool complete = false;     /**< A search ran out of States within the bound, so none was missed */
+      std::size_t restarts = 0;
+    };
+
+    /**
+     * Random restarts: search from \p init in random order, and after
+     * Restarts::bound States start over from \p init with a fresh
+     * SimulationManager from \p makeManager and the next random
+     * stream. Each attempt thus takes a different random path into the
+     * state space instead of sinking into the part the first one chose.
+     * \p makeManager must give each attempt its own storer. Stops when
+     * a goal State is found, an attempt explores everything, the
+     * restarts are used up or \p guard is exceeded.
+     */
+    template <class MakeManager>
+    RestartResult randomRestartSearch(MakeManager makeManager, const MiniMC::CPA::State_ptr& init, const SearchOptions& sopt, const Restarts& restarts, const BudgetGuard_ptr& guard, const Telemetry_ptr& telemetry) {
+      RestartResult res;
+      std::size_t explored = 0;
+      std::size_t steps = 0;
+      for (;; ++res.restarts) {
+        MiniMC::Support::RandomNumber<>::selectStream(res.restarts);
+        SimulationManager manager = makeManager();
+        manager.insert(init);
+        while (manager.getWSize() && manager.getPSize() < restarts.bound && !res.found) {
+          res.found = manager.step(sopt);
+          bool stop = guard && guard->checkStates(explored + manager.getPSize());
+          if (!(++steps % 256)) {
+            if (telemetry)
+              telemetry->tick();
+            stop |= guard && guard->checkResources();
+          }
+          if (stop)
+            break;
+        }
+        explored += manager.getPSize();
+        res.complete = !res.found && !manager.getWSize();
+        if (telemetry)
+          telemetry->setWaiting([]() { return std::size_t{0}; });
+        if (res.found || res.complete || res.restarts == restarts.count || (guard && guard->exceeded() != BudgetExceeded::None))
+          return res;
+      }
+    }
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file   por.hpp
+ *
+ * @brief  Static information for ample set partial order reduction
+ *
+ *
+ */
+#ifndef _POR__
+#define _POR__
+
+#include "model/cfg.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    /**
+     * An edge is \em local if it only touches variables of the
+     * process taking it: it reads and writes no global variables,
+     * does not access the heap, makes no calls and cannot lead to an
+     * assert violation. Local edges are independent of the edges of
+     * all other processes, and other processes cannot enable or
+     * disable them.
+     *
+     * If all outgoing edges of the location of a process are local,
+     * and none of them closes a loop in the CFG, these edges form an
+     * ample set of the State: exploring only them preserves
+     * reachability of assert violations. Excluding loop-closing edges
+     * makes sure every cycle of the reduced state space contains a
+     * fully expanded State.
+     */
+    class PartialOrderReduction {
+    public:
+      PartialOrderReduction(const MiniMC::Model::Program& prgm) {
+        for (auto& func : prgm.getFunctions()) {
+          auto& cfg = func->getCFG();
+          auto back = backEdges(*cfg);
+          for (auto& loc : cfg->getLocations()) {
+            bool ample = loc->hasOutgoingEdge();
+            for (auto it = loc->ebegin(); ample && it != loc->eend(); ++it) {
+              auto edge = *it;
+              ample = !back.count(edge.get()) && isLocal(*edge);
+            }
+            if (ample)
+              reducible.insert(loc.get());
+          }
+        }
+      }
+
+      /**
+       * @return true if the outgoing edges of \p loc form an ample set
+       */
+      bool canReduceAt(const MiniMC::Model::Location* loc) const { return reducible.count(loc); }
+
+      static bool isLocal(const MiniMC::Model::Edge& edge) {
+        if (edge.getTo()->getInfo().is<MiniMC::Model::Attributes::AssertViolated>())
+          return false;
+        if (edge.hasAttribute<MiniMC::Model::AttributeType::Guard>()) {
+          auto& guard = edge.getAttribute<MiniMC::Model::AttributeType::Guard>();
+          if (guard.guard && guard.guard->isGlobal())
+            return false;
+        }
+        if (edge.hasAttribute<MiniMC::Model::AttributeType::Instructions>()) {
+          for (auto& inst : edge.getAttribute<MiniMC::Model::AttributeType::Instructions>()) {
+            if (!isLocal(inst))
+              return false;
+          }
+        }
+        return true;
+      }
+
+      static bool isLocal(const MiniMC::Model::Instruction& inst) {
+        switch (inst.getOpcode()) {
+          case MiniMC::Model::InstructionCode::Alloca:
+          case MiniMC::Model::InstructionCode::FindSpace:
+          case MiniMC::Model::InstructionCode::Malloc:
+          case MiniMC::Model::InstructionCode::Free:
+          case MiniMC::Model::InstructionCode::Store:
+          case MiniMC::Model::InstructionCode::Load:
+          case MiniMC::Model::InstructionCode::ExtendObj:
+          case MiniMC::Model::InstructionCode::MemCpy:
+          case MiniMC::Model::InstructionCode::StackSave:
+          case MiniMC::Model::InstructionCode::StackRestore:
+          case MiniMC::Model::InstructionCode::Call:
+          case MiniMC::Model::InstructionCode::Assert:
+            return false;
+          default:
+            return std::none_of(inst.begin(), inst.end(), [](const MiniMC::Model::Value_ptr& v) {
+              return v && v->isGlobal();
+            });
+        }
+      }
+
+      /**
+       * Record the expansion of a State
+       *
+       * Edges are counted whether or not their guards hold, so the
+       * counts are of outgoing edges, not of enabled ones.
+       *
+       * @param explored number of outgoing edges of the expanded processes
+       * @param outgoing number of outgoing edges of all processes
+       */
+      void record(std::size_t explored, std::size_t outgoing) {
+        expanded++;
+        if (explored < outgoing)
+          reduced++;
+        exploredEdges += explored;
+        outgoingEdges += outgoing;
+      }
+
+      std::size_t getExpanded() const { return expanded; }
+      std::size_t getReduced() const { return reduced; }
+
+      /**
+       * @return fraction of outgoing edges that belonged to an expanded process
+       */
+      double getReductionRatio() const {
+        return outgoingEdges ? static_cast<double>(exploredEdges) / outgoingEdges : 1;
+      }
+
+    private:
+      /**
+       * Edges closing a cycle in a depth first search of \p cfg
+       */
+      static std::unordered_set<const MiniMC::Model::Edge*> backEdges(MiniMC::Model::CFG& cfg) {
+        std::unordered_set<const MiniMC::Model::Edge*> res;
+        enum class Colour { White,
+                            Grey,
+                            Black };
+        std::unordered_map<const MiniMC::Model::Location*, Colour> colour;
+        struct Frame {
+          MiniMC::Model::Location* loc;
+          MiniMC::Model::Location::edge_iterator it;
+        };
+
+        std::vector<MiniMC::Model::Location_ptr> roots{cfg.getInitialLocation().get()};
+        roots.insert(roots.end(), cfg.getLocations().begin(), cfg.getLocations().end());
+        for (auto& root : roots) {
+          if (colour[root.get()] != Colour::White)
+            continue;
+          std::vector<Frame> stack{{root.get(), root->ebegin()}};
+          colour[root.get()] = Colour::Grey;
+          while (stack.size()) {
+            auto& top = stack.back();
+            if (top.it == top.loc->eend()) {
+              colour[top.loc] = Colour::Black;
+              stack.pop_back();
+              continue;
+            }
+            auto edge = *top.it;
+            ++top.it;
+            auto to = edge->getTo().get().get();
+            auto& c = colour[to];
+            if (c == Colour::Grey)
+              res.insert(edge.get());
+            else if (c == Colour::White) {
+              c = Colour::Grey;
+              stack.push_back({to, to->ebegin()});
+            }
+          }
+        }
+        return res;
+      }
+
+      std::unordered_set<const MiniMC::Model::Location*> reducible;
+      std::atomic<std::size_t> expanded = 0;
+      std::atomic<std::size_t> reduced = 0;
+      std::atomic<std::size_t> exploredEdges = 0;
+      std::atomic<std::size_t> outgoingEdges = 0;
+    };
+
+    using PartialOrderReduction_ptr = std::shared_ptr<PartialOrderReduction>;
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
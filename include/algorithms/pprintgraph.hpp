@@ -8,34 +8,66 @@
 #include "support/exceptions.hpp"
 #include "support/feedback.hpp"
 #include "support/localisation.hpp"
+#include "support/statistical/fixed_effort.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <gsl/pointers>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 namespace MiniMC {
   namespace Algorithms {
+    /**
+     * Estimates the probability of reaching an assert violation by
+     * sampling random traces of at most Options::len steps.
+     *
+     * Trace number i draws its random numbers from stream i of
+     * MiniMC::Support::getSeed(), so the sampled traces do not depend
+     * on which thread generates them.
+     *
+     * With more than one thread, each worker generates batches of
+     * Options::batch traces with its own Generator. Batches are numbered when they are started and
+     * merged into \p SMC strictly in that order, one sample at a time,
+     * so the stopping criterion of a sequential \p SMC sees the samples
+     * in an order that does not depend on how long the traces took to
+     * generate. Samples after the stopping point are discarded.
+     * A worker does not start a batch more than 2 * Options::threads
+     * batches ahead of the next one to merge, which bounds the number
+     * of finished batches waiting for a slower one.
+     */
     template <class SMC>
     class ProbaChecker : public MiniMC::Algorithms::Algorithm {
     public:
       struct Options {
         std::size_t len;
         typename SMC::Options smcoptions;
+        std::size_t threads = 1;
+        std::size_t batch = 64;
       };
 
-      ProbaChecker(const Options& opt) : messager(MiniMC::Support::getMessager()), smc(opt.smcoptions), length(opt.len) {
-        cpa = std::make_shared<MiniMC::CPA::Compounds::CPA>(std::initializer_list<MiniMC::CPA::CPA_ptr>({
-            std::make_shared<MiniMC::CPA::Location::CPA>(),
-            std::make_shared<MiniMC::CPA::Concrete::CPA>(),
-        }));
+      ProbaChecker(const Options& opt) : messager(MiniMC::Support::getMessager()), smc(opt.smcoptions), length(opt.len), threads(std::max<std::size_t>(opt.threads, 1)), batch(std::max<std::size_t>(opt.batch, 1)) {
+        cpa = std::make_shared<MiniMC::CPA::Compounds::Compound<1, MiniMC::CPA::Location::CPA,
+                                                                   MiniMC::CPA::Concrete::CPA>>();
       }
       virtual Result run(const MiniMC::Model::Program& prgm) {
         messager.message("Initiating SMC");
         if (!cpa->makeValidate()->validate(prgm, messager)) {
           return Result::Error;
         }
+        messager.message(MiniMC::Support::Localiser{"Random seed: %1%"}.format(MiniMC::Support::getSeed()));
         auto initstate = cpa->makeQuery()->makeInitialState(prgm);
         try {
-          while (smc.continueSampling()) {
-            generateTrace(initstate);
+          if (threads > 1)
+            runParallel(initstate);
+          else {
+            MiniMC::Algorithms::Proba::Generator generator(cpa->makeTransfer());
+            for (std::size_t trace = 0; smc.continueSampling(); ++trace) {
+              smc.sample(generateTrace(initstate, generator, trace));
+            }
           }
         } catch (MiniMC::Support::VerificationException& exc) {
           messager.error(exc.what());
@@ -45,9 +77,11 @@ namespace MiniMC {
         return Result::Success;
       }
 
-      void generateTrace(MiniMC::CPA::State_ptr state) {
+      const SMC& getEstimator() const { return smc; }
+
+      MiniMC::Support::Statistical::Result generateTrace(MiniMC::CPA::State_ptr state, MiniMC::Algorithms::Proba::Generator& generator, std::size_t trace) {
+        MiniMC::Support::RandomNumber<>::selectStream(trace);
         auto cur = state;
-        MiniMC::Algorithms::Proba::Generator generator(cpa->makeTransfer());
         for (size_t i = 0; i < length; i++) {
           auto it = generator.generate(cur).first;
           cur = it->state;
@@ -55,18 +89,92 @@ namespace MiniMC {
             break;
           auto loc = cur->getLocation(it->proc);
           if (loc->getInfo().template is<MiniMC::Model::Attributes::AssertViolated>()) {
-            smc.sample(MiniMC::Support::Statistical::Result::Satis);
-            return;
+            return MiniMC::Support::Statistical::Result::Satis;
           }
         }
-        smc.sample(MiniMC::Support::Statistical::Result::NSatis);
+        return MiniMC::Support::Statistical::Result::NSatis;
       }
 
     private:
+      using Batch = std::vector<MiniMC::Support::Statistical::Result>;
+
+      void runParallel(const MiniMC::CPA::State_ptr& initstate) {
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < threads; ++i) {
+          workers.emplace_back([this, &initstate]() { work(initstate); });
+        }
+        for (auto& t : workers)
+          t.join();
+        if (error)
+          std::rethrow_exception(error);
+      }
+
+      void work(const MiniMC::CPA::State_ptr& initstate) {
+        try {
+          MiniMC::Algorithms::Proba::Generator generator(cpa->makeTransfer());
+          while (!done) {
+            auto id = nextBatch++;
+            {
+              std::unique_lock lock(mergeMutex);
+              merged.wait(lock, [this, id]() { return done || id < nextMerge + 2 * threads; });
+            }
+            if (done)
+              break;
+            Batch samples;
+            samples.reserve(batch);
+            for (std::size_t i = 0; i < batch && !done; ++i)
+              samples.push_back(generateTrace(initstate, generator, id * batch + i));
+            if (samples.size() == batch)
+              merge(id, std::move(samples));
+          }
+        } catch (...) {
+          {
+            std::scoped_lock lock(mergeMutex);
+            if (!error)
+              error = std::current_exception();
+            done = true;
+          }
+          merged.notify_all();
+        }
+      }
+
+      /**
+       * Merge all batches that are next in line into \p SMC
+       */
+      void merge(std::size_t id, Batch&& samples) {
+        std::unique_lock lock(mergeMutex);
+        pendingBatches.emplace(id, std::move(samples));
+        for (auto it = pendingBatches.find(nextMerge); it != pendingBatches.end() && !done; it = pendingBatches.find(nextMerge)) {
+          for (auto res : it->second) {
+            if (!smc.continueSampling()) {
+              done = true;
+              break;
+            }
+            smc.sample(res);
+          }
+          pendingBatches.erase(it);
+          nextMerge++;
+        }
+        if (!smc.continueSampling())
+          done = true;
+        lock.unlock();
+        merged.notify_all();
+      }
+
       MiniMC::Support::Messager& messager;
       SMC smc;
       std::size_t length;
+      std::size_t threads;
+      std::size_t batch;
       MiniMC::CPA::CPA_ptr cpa;
+
+      std::atomic<std::size_t> nextBatch = 0;
+      std::atomic<bool> done = false;
+      std::mutex mergeMutex;
+      std::condition_variable merged;
+      std::size_t nextMerge = 0;
+      std::map<std::size_t, Batch> pendingBatches;
+      std::exception_ptr error = nullptr;
     };
 
   } // namespace Algorithms
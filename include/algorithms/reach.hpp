@@ -2,14 +2,18 @@
 #define _PRINTGGRAPH__
 
 #include "algorithms/algorithm.hpp"
+#include "algorithms/heuristics.hpp"
 #include "algorithms/simulationmanager.hpp"
 #include "algorithms/successorgen.hpp"
+#include "algorithms/symmetry.hpp"
 #include "cpa/compound.hpp"
 #include "cpa/concrete.hpp"
 #include "cpa/location.hpp"
 #include "support/exceptions.hpp"
 #include "support/feedback.hpp"
 #include "support/localisation.hpp"
+#include "support/timing.hpp"
+#include <chrono>
 #include <functional>
 #include <sstream>
 
@@ -35,15 +39,43 @@ namespace MiniMC {
         };
 
         MiniMC::CPA::CPA_ptr cpa = nullptr;
+        std::size_t threads = 1;
+        bool partialOrder = false; /**< Use partial order reduction */
+        bool symmetry = false;     /**< Identify States that differ only in the order of interchangeable processes */
+        SearchStrategy search = SearchStrategy::DepthFirst;
+        std::string checkpoint;                        /**< Checkpoint file, empty for no checkpoints */
+        std::chrono::seconds checkpointInterval{1800}; /**< Time between checkpoints */
+        std::string resume;                            /**< Checkpoint to continue from, empty to start afresh */
+        MiniMC::Hash::hash_t setup = 0;                /**< setupHash of the SetupOptions used to prepare the program */
+        std::chrono::seconds statsInterval{10};        /**< Time between progress reports, 0 for none */
+        std::string statsOut;                          /**< File for the final statistics as JSON, empty for none */
+        Budget budget;                                 /**< Limits after which the search stops as Inconclusive */
+        Restarts restarts;                             /**< Used by SearchStrategy::RandomRestart */
       };
       Reachability(const Options& opt) : messager(MiniMC::Support::getMessager()),
                                          predicate(opt.predicate),
                                          filter(opt.filter),
-                                         cpa(opt.cpa) {}
+                                         cpa(opt.cpa),
+                                         threads(opt.threads),
+                                         partialOrder(opt.partialOrder),
+                                         symmetry(opt.symmetry),
+                                         search(opt.search),
+                                         checkpoint(opt.checkpoint),
+                                         checkpointInterval(opt.checkpointInterval),
+                                         resume(opt.resume),
+                                         setup(opt.setup),
+                                         statsInterval(opt.statsInterval),
+                                         statsOut(opt.statsOut),
+                                         budget(opt.budget),
+                                         restarts(opt.restarts) {}
 
       virtual Result run(const MiniMC::Model::Program& prgm) {
-        if (!cpa->makeValidate()->validate(prgm, messager)) {
-          return Result::Error;
+        auto guard = budget.unlimited() ? nullptr : std::make_shared<BudgetGuard>(budget);
+        {
+          MiniMC::Support::Phase phase("Validation");
+          if (!cpa->makeValidate()->validate(prgm, messager)) {
+            return Result::Error;
+          }
         }
 
         messager.message("Initiating Reachability");
@@ -52,13 +84,65 @@ namespace MiniMC {
         MiniMC::CPA::State_ptr foundState = nullptr;
 
         auto progresser = messager.makeProgresser();
+        auto telemetry = std::make_shared<Telemetry>(statsInterval, [&progresser](const TelemetrySample& s) { progresser->progressMessage(formatSample(s)); });
 
         auto initstate = query->makeInitialState(prgm);
+        SymmetryReduction_ptr symmetryReduction = nullptr;
+        if (symmetry) {
+          symmetryReduction = std::make_shared<SymmetryReduction>(prgm);
+          if (!symmetryReduction->supports(initstate)) {
+            messager.warning("CPA does not support symmetry reduction");
+            symmetryReduction = nullptr;
+          } else {
+            transfer = std::make_shared<SymmetricTransferer>(transfer, symmetryReduction);
+          }
+        }
+
+        if (search == SearchStrategy::RandomRestart)
+          return runRestarts(prgm, transfer, telemetry, guard, symmetryReduction ? symmetryReduction->canonical(initstate) : initstate);
+
+        auto searchSetup = makeSearch(search, prgm);
+        CheckpointHeader header{.program = programHash(prgm), .setup = setup, .search = searchHash(*cpa, symmetryReduction != nullptr, partialOrder)};
+        auto checkpointer = checkpoint.size() ? std::make_shared<Checkpointer>(checkpoint, header, checkpointInterval) : nullptr;
         MiniMC::Algorithms::SimulationManager simmanager(MiniMC::Algorithms::SimManagerOptions{
             .storer = cpa->makeStore(),
             .joiner = cpa->makeJoin(),
-            .transfer = cpa->makeTransfer()});
-        simmanager.insert(initstate);
+            .transfer = transfer,
+            .threads = threads,
+            .por = partialOrder ? std::make_shared<PartialOrderReduction>(prgm) : nullptr,
+            .order = searchSetup.order,
+            .priority = searchSetup.priority,
+            .checkpointer = checkpointer,
+            .telemetry = telemetry,
+            .budget = guard,
+            .load = [query, &prgm](MiniMC::Support::Reader& reader) { return query->deserialize(reader, prgm); }});
+        if (threads > 1 && !simmanager.supportsParallel()) {
+          messager.warning("CPA or storage does not support parallel search. Using a single thread");
+        } else if (threads > 1 && search != SearchStrategy::DepthFirst) {
+          messager.warning("The parallel search does not use the selected search strategy");
+        }
+        bool writesCheckpoints = simmanager.supportsCheckpoint() && !(threads > 1 && simmanager.supportsParallel());
+        if (checkpointer && !writesCheckpoints) {
+          messager.warning("Checkpoints are only written by the sequential search with exact storage");
+        }
+        MiniMC::Support::Timer timer("Reachability", true);
+        if (resume.size()) {
+          try {
+            auto ckpt = Checkpoint::read(resume);
+            if (ckpt.header != header) {
+              messager.error("Checkpoint was taken of another program or with other setup or search options");
+              return Result::Error;
+            }
+            auto reader = ckpt.body();
+            simmanager.restore(reader, *query, prgm);
+          } catch (MiniMC::Support::Exception& exc) {
+            messager.error(exc.what());
+            return Result::Error;
+          }
+          messager.message(MiniMC::Support::Localiser("Resumed from %1%: %2% states waiting").format(resume, simmanager.getWSize()));
+        } else {
+          simmanager.insert(symmetryReduction ? symmetryReduction->canonical(initstate) : initstate);
+        }
         foundState = simmanager.reachabilitySearch({.filter = filter,
                                                     .goal = predicate
 
@@ -66,25 +150,112 @@ namespace MiniMC {
         //foundState = MiniMC::Algorithms::reachabilitySearch (passed,insert,initstate,predicate,transfer);
 
         messager.message("Finished Reachability");
+        auto exceeded = simmanager.budgetExceeded();
+        if (!foundState && exceeded != BudgetExceeded::None) {
+          messager.warning(MiniMC::Support::Localiser("Search stopped: %1% budget exceeded").format(exceeded));
+          reportCoverage(messager, prgm, simmanager);
+          if (checkpointer && writesCheckpoints)
+            checkpointer->save(simmanager.checkpoint());
+        }
+        if (checkpointer) {
+          checkpointer->wait();
+          messager.message(MiniMC::Support::Localiser("Checkpoints written: %1%").format(checkpointer->getWritten()));
+          if (checkpointer->getFailed())
+            messager.warning(MiniMC::Support::Localiser("Could not write %1% checkpoints").format(checkpointer->getFailed()));
+        }
         if (foundState) {
           result.result = ReachabilityResult::Found;
           result.foundState = foundState;
-          return Result::Success;
+        } else if (exceeded != BudgetExceeded::None) {
+          result.result = ReachabilityResult::Inconclusive;
         } else {
           result.result = ReachabilityResult::NotFound;
-          return Result::Success;
+        }
+        reportTelemetry(messager, telemetry, statsOut, resultName(result.result));
+        reportThreadStatistics(messager, simmanager.getThreadStatistics());
+        reportStorage(messager, simmanager.getStorer());
+        reportPartialOrder(messager, simmanager.getPartialOrder());
+        reportSymmetry(messager, symmetryReduction);
+        if (foundState)
+          messager.message(MiniMC::Support::Localiser("Time to first counterexample: %1% ms").format(timer.current().milliseconds));
+        return Result::Success;
+      }
+
+      /**
+       * @return \p r as written to the statistics file
+       */
+      static std::string resultName(ReachabilityResult r) {
+        switch (r) {
+          case ReachabilityResult::Found:
+            return "Found";
+          case ReachabilityResult::NotFound:
+            return "NotFound";
+          default:
+            return "Inconclusive";
         }
       }
 
       const auto& getAnalysisResult() const { return result; }
 
     private:
+      /**
+       * SearchStrategy::RandomRestart in place of the single search.
+       * Restarts search sequentially and write no checkpoints.
+       */
+      Result runRestarts(const MiniMC::Model::Program& prgm, const MiniMC::CPA::Transferer_ptr& transfer, const Telemetry_ptr& telemetry, const BudgetGuard_ptr& guard, const MiniMC::CPA::State_ptr& init) {
+        if (threads > 1 || checkpoint.size() || resume.size())
+          messager.warning("Random restarts search on a single thread without checkpoints");
+        auto searchSetup = makeSearch(search, prgm);
+        auto query = cpa->makeQuery();
+        auto makeManager = [&]() {
+          return SimulationManager(SimManagerOptions{
+              .storer = cpa->makeStore(),
+              .joiner = cpa->makeJoin(),
+              .transfer = transfer,
+              .por = partialOrder ? std::make_shared<PartialOrderReduction>(prgm) : nullptr,
+              .order = searchSetup.order,
+              .priority = searchSetup.priority,
+              .telemetry = telemetry,
+              .load = [query, &prgm](MiniMC::Support::Reader& reader) { return query->deserialize(reader, prgm); }});
+        };
+        MiniMC::Support::Timer timer("Reachability", true);
+        auto res = randomRestartSearch(makeManager, init, {.filter = filter, .goal = predicate}, restarts, guard, telemetry);
+        messager.message(MiniMC::Support::Localiser("Finished Reachability after %1% restarts").format(res.restarts));
+        if (res.found) {
+          messager.message(MiniMC::Support::Localiser("Time to first counterexample: %1% ms").format(timer.current().milliseconds));
+          result.result = ReachabilityResult::Found;
+          result.foundState = res.found;
+        } else if (res.complete) {
+          result.result = ReachabilityResult::NotFound;
+        } else {
+          if (guard && guard->exceeded() != BudgetExceeded::None)
+            messager.warning(MiniMC::Support::Localiser("Search stopped: %1% budget exceeded").format(guard->exceeded()));
+          else
+            messager.warning(MiniMC::Support::Localiser("Search stopped after %1% restarts of %2% states").format(res.restarts, restarts.bound));
+          result.result = ReachabilityResult::Inconclusive;
+        }
+        reportTelemetry(messager, telemetry, statsOut, resultName(result.result));
+        return Result::Success;
+      }
+
       MiniMC::Support::Messager& messager;
       AnalysisResult result{.result = ReachabilityResult::Inconclusive};
       MiniMC::Algorithms::GoalFunction predicate;
       MiniMC::Algorithms::FilterFunction filter;
       ;
       MiniMC::CPA::CPA_ptr cpa;
+      std::size_t threads;
+      bool partialOrder;
+      bool symmetry;
+      SearchStrategy search;
+      std::string checkpoint;
+      std::chrono::seconds checkpointInterval;
+      std::string resume;
+      MiniMC::Hash::hash_t setup;
+      std::chrono::seconds statsInterval;
+      std::string statsOut;
+      Budget budget;
+      Restarts restarts;
     };
   } // namespace Algorithms
 } // namespace MiniMC
@@ -9,12 +9,21 @@
 #ifndef _PASSED__
 #define _PASSED__
 
+#include "algorithms/budget.hpp"
+#include "algorithms/checkpoint.hpp"
 #include "algorithms/successorgen.hpp"
+#include "algorithms/telemetry.hpp"
+#include "algorithms/waitinglist.hpp"
+#include "algorithms/workstealing.hpp"
+#include "cpa/approximate.hpp"
 #include "cpa/interface.hpp"
 #include "support/feedback.hpp"
+#include "support/localisation.hpp"
 #include <functional>
 #include <gsl/pointers>
-#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace MiniMC {
   namespace Algorithms {
@@ -29,6 +38,14 @@ namespace MiniMC {
       MiniMC::CPA::Storer_ptr storer;
       MiniMC::CPA::Joiner_ptr joiner;
       MiniMC::CPA::Transferer_ptr transfer;
+      std::size_t threads = 1; /**< Number of threads used by reachabilitySearch */
+      PartialOrderReduction_ptr por = nullptr;
+      SearchOrder order = SearchOrder::DepthFirst;
+      WaitingList::PriorityFunction priority = nullptr; /**< Used by SearchOrder::Priority */
+      Checkpointer_ptr checkpointer = nullptr;          /**< Periodically checkpoint the sequential search */
+      Telemetry_ptr telemetry = nullptr;                /**< Counters updated by the searches */
+      BudgetGuard_ptr budget = nullptr;                 /**< Stops reachabilitySearch when exceeded */
+      MiniMC::CPA::ExternalQueue::Loader load = nullptr; /**< Reads back the States the search spills to disk with an ExternalStorer */
     };
 
     struct SearchOptions {
@@ -37,49 +54,104 @@ namespace MiniMC {
       GoalFunction goal = [](const MiniMC::CPA::State_ptr& s) { return false; };
     };
 
+    inline void reportThreadStatistics(MiniMC::Support::Messager& messager, const std::vector<ThreadStatistics>& stats) {
+      for (std::size_t i = 0; i < stats.size(); ++i) {
+        auto& t = stats[i];
+        double rate = t.seconds > 0 ? t.explored / t.seconds : 0;
+        messager.message(MiniMC::Support::Localiser("Thread %1%: %2% states explored, %3% stolen, %4% states/s").format(i, t.explored, t.steals, static_cast<std::size_t>(rate)));
+      }
+    }
+
+    /**
+     * Report how much an approximate storer may have missed, or how
+     * much a CollapseStorer shares. Does nothing for other exact
+     * storers.
+     */
+    inline void reportStorage(MiniMC::Support::Messager& messager, const MiniMC::CPA::Storer_ptr& storer) {
+      if (auto approx = std::dynamic_pointer_cast<MiniMC::CPA::ApproximateStorer>(storer)) {
+        messager.message(MiniMC::Support::Localiser("Approximate storage: %1% states in %2% bytes").format(approx->stored(), approx->memory()));
+        messager.message(MiniMC::Support::Localiser("Estimated probability of missed states: %1%").format(approx->omissionProbability()));
+        if (auto compact = std::dynamic_pointer_cast<MiniMC::CPA::HashCompactionStorer>(storer); compact && compact->getDropped()) {
+          messager.warning(MiniMC::Support::Localiser("Hash table full: %1% states were not stored").format(compact->getDropped()));
+        }
+      } else if (auto external = std::dynamic_pointer_cast<MiniMC::CPA::ExternalStorer>(storer)) {
+        messager.message(MiniMC::Support::Localiser("External storage: %1% states, %2% bytes on disk, %3% merges").format(external->stored(), external->diskBytes(), external->getFlushes()));
+        messager.message(MiniMC::Support::Localiser("Estimated probability of missed states: %1%").format(external->omissionProbability()));
+      } else if (auto collapse = std::dynamic_pointer_cast<MiniMC::CPA::CollapseStorer>(storer)) {
+        messager.message(MiniMC::Support::Localiser("Collapse compression: %1% states").format(collapse->getStored()));
+        for (auto& [name, table] : collapse->getInterner()) {
+          messager.message(MiniMC::Support::Localiser("%1%: %2% distinct of %3%").format(name, table->size(), table->getLookups()));
+        }
+      }
+    }
+
+    inline void reportPartialOrder(MiniMC::Support::Messager& messager, const PartialOrderReduction_ptr& por) {
+      if (por) {
+        messager.message(MiniMC::Support::Localiser("Partial order reduction: %1% of %2% states reduced, %3%%% of outgoing edges explored").format(por->getReduced(), por->getExpanded(), por->getReductionRatio() * 100));
+      }
+    }
+
     class SimulationManager {
     public:
-      SimulationManager(SimManagerOptions opt) : doStore(opt.storage),
+      SimulationManager(SimManagerOptions opt) : waiting(opt.order, opt.priority),
+                                                 order(opt.order),
+                                                 priority(opt.priority),
+                                                 doStore(opt.storage),
                                                  storage(opt.storer),
                                                  joiner(opt.joiner),
-                                                 generator(opt.transfer) {}
+                                                 transfer(opt.transfer),
+                                                 generator(opt.transfer, opt.por),
+                                                 threads(opt.threads),
+                                                 por(opt.por),
+                                                 checkpointer(opt.checkpointer),
+                                                 telemetry(opt.telemetry),
+                                                 budget(opt.budget),
+                                                 load(opt.load) {
+        if (telemetry)
+          telemetry->setWaiting([this]() { return waiting.size(); });
+      }
 
       std::size_t getWSize() const { return waiting.size(); }
       std::size_t getPSize() const { return passed; }
 
+      /**
+       * @return number of States in the storer
+       */
+      std::size_t getStored() const {
+        if (auto approx = std::dynamic_pointer_cast<MiniMC::CPA::ApproximateStorer>(storage))
+          return approx->stored();
+        if (auto external = std::dynamic_pointer_cast<MiniMC::CPA::ExternalStorer>(storage))
+          return external->stored();
+        return storage->stored_end() - storage->stored_begin();
+      }
+
       auto stored_begin() { return storage->stored_begin(); }
       auto stored_end() { return storage->stored_end(); }
 
-      auto waiting_begin() { return waiting.begin(); }
-      auto waiting_end() { return waiting.end(); }
+      template <class Func>
+      void for_each_waiting(Func func) const {
+        waiting.for_each(func);
+      }
 
       void insert(gsl::not_null<MiniMC::CPA::State_ptr> ptr) {
         _insert(ptr, SearchOptions{});
       }
 
-      MiniMC::CPA::State_ptr step_first(const SearchOptions& sopt) {
-        if (waiting.size()) {
-          auto search = waiting.front();
-          waiting.pop_front();
-          return _step(search, sopt);
-        }
-        return nullptr;
-      }
-
-      MiniMC::CPA::State_ptr step_last(const SearchOptions& sopt) {
+      /**
+       * Explore the next waiting State in SimManagerOptions::order
+       */
+      MiniMC::CPA::State_ptr step(const SearchOptions& sopt) {
         if (waiting.size()) {
-          auto search = waiting.back();
-          waiting.pop_back();
-          return _step(search, sopt);
+          return _step(waiting.pop(), sopt);
         }
         return nullptr;
       }
 
       MiniMC::CPA::State_ptr step_all(const SearchOptions& sopt) {
-        std::list<MiniMC::CPA::State_ptr> list;
+        WaitingList list(order, priority);
         std::swap(list, waiting);
-        for (auto& s : list) {
-          auto res = _step(s, sopt);
+        while (list.size()) {
+          auto res = _step(list.pop(), sopt);
           if (res)
             return res;
         }
@@ -87,20 +159,233 @@ namespace MiniMC {
         return nullptr;
       }
 
+      /**
+       * The parallel search requires the passed set to be split
+       * between threads, which is only sound when States are covered
+       * by equal States only (i.e. the CPA stores in a HashStorer).
+       * Its passed set does not intern States, so a CollapseStorer
+       * would not compress anything and is searched sequentially.
+       */
+      bool supportsParallel() const {
+        return std::dynamic_pointer_cast<MiniMC::CPA::HashStorer>(storage) != nullptr &&
+               !std::dynamic_pointer_cast<MiniMC::CPA::CollapseStorer>(storage);
+      }
+
+      const std::vector<ThreadStatistics>& getThreadStatistics() const { return threadStats; }
+
+      /**
+       * Checkpoints enumerate the stored States, which the
+       * approximate and external storers do not keep.
+       */
+      bool supportsCheckpoint() const {
+        return !std::dynamic_pointer_cast<MiniMC::CPA::ApproximateStorer>(storage) &&
+               !std::dynamic_pointer_cast<MiniMC::CPA::ExternalStorer>(storage);
+      }
+
+      /**
+       * Serialize the passed counter, the stored States and the
+       * waiting States. A waiting State that is also stored is written
+       * as the position of the stored State, so it is shared again
+       * after restore.
+       */
+      std::vector<MiniMC::uint8_t> checkpoint() {
+        std::vector<MiniMC::uint8_t> res;
+        MiniMC::Support::Writer writer(res);
+        std::unordered_map<const MiniMC::CPA::State*, std::size_t> positions;
+        writer.varint(passed);
+        writer.varint(storage->stored_end() - storage->stored_begin());
+        for (auto it = storage->stored_begin(); it != storage->stored_end(); ++it) {
+          positions.emplace(it->get(), positions.size());
+          (*it)->serialize(writer);
+        }
+        writer.varint(waiting.size());
+        waiting.for_each([&](const MiniMC::CPA::State_ptr& s) {
+          auto it = positions.find(s.get());
+          if (it != positions.end())
+            writer.varint(it->second + 1);
+          else {
+            writer.varint(0);
+            s->serialize(writer);
+          }
+        });
+        return res;
+      }
+
+      /**
+       * Continue from a checkpoint written by checkpoint instead of
+       * inserting an initial State
+       */
+      void restore(MiniMC::Support::Reader& reader, MiniMC::CPA::StateQuery& query, const MiniMC::Model::Program& prgm) {
+        passed = reader.varint();
+        std::vector<MiniMC::CPA::State_ptr> stored(reader.varint());
+        for (auto& s : stored) {
+          s = query.deserialize(reader, prgm);
+          storage->saveState(s);
+        }
+        auto nbWaiting = reader.varint();
+        for (std::size_t i = 0; i < nbWaiting; ++i) {
+          auto ref = reader.varint();
+          if (ref > stored.size())
+            throw MiniMC::Support::SerializationError("Invalid stored State in checkpoint");
+          waiting.push(ref ? stored[ref - 1] : query.deserialize(reader, prgm));
+        }
+        if (!reader.atEnd())
+          throw MiniMC::Support::SerializationError("Trailing bytes after checkpoint");
+      }
+
+      const MiniMC::CPA::Storer_ptr& getStorer() const { return storage; }
+
+      /**
+       * @return the limit that stopped reachabilitySearch, if any. The
+       * unexplored States are left on the waiting list.
+       */
+      BudgetExceeded budgetExceeded() const { return budget ? budget->exceeded() : BudgetExceeded::None; }
+
+      const PartialOrderReduction_ptr& getPartialOrder() const { return por; }
+
       MiniMC::CPA::State_ptr reachabilitySearch(const SearchOptions& sopt) {
+        MiniMC::Support::Phase phase("Search");
+        if (threads > 1 && supportsParallel()) {
+          return parallelReachabilitySearch(sopt);
+        }
+        if (auto external = std::dynamic_pointer_cast<MiniMC::CPA::ExternalStorer>(storage)) {
+          return externalReachabilitySearch(*external, sopt);
+        }
         while (waiting.size()) {
-          auto res = step_first(sopt);
+          auto res = step(sopt);
           if (res) {
             return res;
           }
+          if (budget && budget->checkStates(passed))
+            break;
+          if (!(++steps % clockCheckInterval)) {
+            if (checkpointer && checkpointer->due())
+              checkpointer->save(checkpoint());
+            if (telemetry)
+              telemetry->tick();
+            if (budget && budget->checkResources())
+              break;
+          }
         }
         return nullptr;
       }
 
     private:
+      // Number of steps between looking at the clock for due checkpoints, telemetry and the budget
+      static constexpr std::size_t clockCheckInterval = 256;
+
+      /**
+       * Layered breadth first search for the ExternalStorer. The
+       * layers are kept on disk in ExternalQueues; only the States
+       * generated since the storer was last flushed are in memory, on
+       * the waiting list. The storer is flushed, and the surviving
+       * waiting States are spilled to the next layer, whenever the
+       * storer is full, the waiting list holds as many States as the
+       * storer and at the end of each layer. When the budget stops the
+       * search, the unexplored States are read back onto the waiting
+       * list.
+       */
+      MiniMC::CPA::State_ptr externalReachabilitySearch(MiniMC::CPA::ExternalStorer& external, const SearchOptions& sopt) {
+        if (!load)
+          throw MiniMC::Support::Exception("The external search needs a loader for the States it spills to disk");
+        auto makeLayer = [&]() { return std::make_unique<MiniMC::CPA::ExternalQueue>(external.directory(), load); };
+        auto next = makeLayer();
+        auto spill = [&]() {
+          removeDuplicates(external);
+          while (waiting.size())
+            next->push(waiting.pop());
+        };
+        std::unique_ptr<MiniMC::CPA::ExternalQueue> layer;
+        if (telemetry)
+          telemetry->setWaiting([&]() { return waiting.size() + next->size() + (layer ? layer->size() : 0); });
+        auto res = [&]() -> MiniMC::CPA::State_ptr {
+          spill();
+          while (next->size()) {
+            layer = std::move(next);
+            next = makeLayer();
+            while (auto cur = layer->pop()) {
+              auto res = _step(cur, sopt);
+              if (res)
+                return res;
+              if (external.full() || waiting.size() >= external.getCapacity())
+                spill();
+              bool stop = budget && budget->checkStates(passed);
+              if (!(++steps % clockCheckInterval)) {
+                if (telemetry)
+                  telemetry->tick();
+                stop |= budget && budget->checkResources();
+              }
+              if (stop) {
+                spill();
+                for (auto queue : {layer.get(), next.get()}) {
+                  while (auto s = queue->pop())
+                    waiting.push(s);
+                }
+                return nullptr;
+              }
+            }
+            spill();
+          }
+          return nullptr;
+        }();
+        if (telemetry)
+          telemetry->setWaiting([this]() { return waiting.size(); });
+        return res;
+      }
+
+      void removeDuplicates(MiniMC::CPA::ExternalStorer& external) {
+        auto duplicates = external.flush();
+        if (duplicates.size()) {
+          passed -= waiting.remove_if([&duplicates](const MiniMC::CPA::State_ptr& s) {
+            auto it = duplicates.find(s.get());
+            return it != duplicates.end() && it->second == s->hash();
+          });
+        }
+      }
+
+      MiniMC::CPA::State_ptr parallelReachabilitySearch(const SearchOptions& sopt) {
+        WorkStealingSearch search({.threads = threads,
+                                   .storage = doStore,
+                                   .joiner = joiner,
+                                   .transfer = transfer,
+                                   .por = por,
+                                   .filter = sopt.filter,
+                                   .delay = sopt.delay,
+                                   .goal = sopt.goal,
+                                   .telemetry = telemetry,
+                                   .budget = budget,
+                                   .passed = passed});
+        for (auto it = storage->stored_begin(); it != storage->stored_end(); ++it)
+          search.addPassed(*it);
+        waiting.for_each([&search](const MiniMC::CPA::State_ptr& s) { search.addWaiting(s); });
+        waiting.clear();
+
+        if (telemetry)
+          telemetry->setWaiting([&search]() { return search.getPending(); });
+        auto res = search.run();
+        if (telemetry)
+          telemetry->setWaiting([this]() { return waiting.size(); });
+
+        search.for_each_passed([this](const MiniMC::CPA::State_ptr& s) {
+          if (!storage->isCoveredByStore(s))
+            storage->saveState(s);
+        });
+        search.for_each_waiting([this](const MiniMC::CPA::State_ptr& s) {
+          waiting.push(s);
+        });
+        threadStats = search.getStatistics();
+        for (auto& t : threadStats)
+          passed += t.inserted;
+        return res;
+      }
+
       MiniMC::CPA::State_ptr _step(gsl::not_null<MiniMC::CPA::State_ptr> ptr, const SearchOptions& soptions) {
         auto succs = generator.generate(ptr);
+        if (telemetry)
+          telemetry->explored.add();
         for (auto it = succs.first; it != succs.second; ++it) {
+          if (telemetry)
+            telemetry->generated.add();
           if (soptions.filter(it->state)) {
             if (soptions.goal(it->state)) {
               return it->state;
@@ -126,7 +411,7 @@ namespace MiniMC {
           if (soptions.delay(inst))
             return nullptr;
           else {
-            waiting.push_front(inst);
+            waiting.push(inst);
             passed++;
             return inst;
           }
@@ -134,13 +419,8 @@ namespace MiniMC {
 
         auto repl_or_insert = [&](const typename MiniMC::CPA::IStorer::JoinPair& p) {
           if (!soptions.delay(p.orig)) {
-            auto it = waiting.begin();
-            auto end = waiting.end();
-            auto ff = std::find(it, end, p.orig);
-            if (ff != end)
-              *ff = p.joined;
-            else {
-              waiting.push_front(p.joined);
+            if (!waiting.replace(p.orig, p.joined)) {
+              waiting.push(p.joined);
               passed++;
             }
             return p.joined;
@@ -153,26 +433,73 @@ namespace MiniMC {
         if (doStore(ptr)) {
           auto cover = storage->isCoveredByStore(ptr.get());
           if (cover) {
+            if (telemetry)
+              telemetry->covered.add();
             return cover;
           }
           auto join = storage->joinState(ptr.get());
           if (join.orig) {
+            if (telemetry)
+              telemetry->joined.add();
             return repl_or_insert(join);
           }
+          if (telemetry)
+            telemetry->stored.add();
         }
         return insert(ptr);
       }
 
-      std::list<MiniMC::CPA::State_ptr> waiting;
+      WaitingList waiting;
+      SearchOrder order;
+      WaitingList::PriorityFunction priority;
       std::size_t passed = 0;
       FilterFunction filter;
       DelaySearchPredicate delay;
       StoreStatePredicate doStore;
       MiniMC::CPA::Storer_ptr storage;
       MiniMC::CPA::Joiner_ptr joiner;
+      MiniMC::CPA::Transferer_ptr transfer;
       MiniMC::Algorithms::Generator generator;
+      std::size_t threads;
+      PartialOrderReduction_ptr por;
+      std::vector<ThreadStatistics> threadStats;
+      Checkpointer_ptr checkpointer;
+      Telemetry_ptr telemetry;
+      BudgetGuard_ptr budget;
+      MiniMC::CPA::ExternalQueue::Loader load;
+      std::size_t steps = 0;
     };
 
+    /**
+     * Report how far a search got: the Locations of \p prgm that a
+     * process of a stored or waiting State is at, and the number of
+     * States stored and waiting. Approximate storers do not keep their
+     * States, so the Locations reached are a lower bound.
+     */
+    inline void reportCoverage(MiniMC::Support::Messager& messager, const MiniMC::Model::Program& prgm, SimulationManager& manager) {
+      std::unordered_set<const MiniMC::Model::Location*> reached;
+      auto visit = [&reached](const MiniMC::CPA::State_ptr& s) {
+        try {
+          for (MiniMC::CPA::proc_id p = 0; p < s->nbOfProcesses(); ++p)
+            reached.insert(s->getLocation(p).get());
+        } catch (MiniMC::Support::Exception&) {
+        }
+      };
+      for (auto it = manager.stored_begin(); it != manager.stored_end(); ++it)
+        visit(*it);
+      manager.for_each_waiting(visit);
+
+      std::size_t locations = 0;
+      std::size_t covered = 0;
+      for (auto& func : prgm.getFunctions()) {
+        for (auto& loc : func->getCFG()->getLocations()) {
+          locations++;
+          covered += reached.count(loc.get());
+        }
+      }
+      messager.message(MiniMC::Support::Localiser("Coverage: %1% of %2% locations reached, %3% states stored, %4% waiting").format(covered, locations, manager.getStored(), manager.getWSize()));
+    }
+
   } // namespace Algorithms
 } // namespace MiniMC
 
@@ -1,6 +1,7 @@
 #ifndef _SUCCESSOR_GEN__
 #define _SUCCESSOR_GEN__
 
+#include "algorithms/por.hpp"
 #include "cpa/interface.hpp"
 #include "support/exceptions.hpp"
 #include "support/types.hpp"
@@ -42,6 +43,21 @@ namespace MiniMC {
           return Iterator(pt, proc - 1, proc, loc->eend(), loc->eend(), transfer);
         }
 
+        /**
+         * Iterators over the successors of process \p proc only
+         */
+        static Iterator makeProcBegin(const MiniMC::CPA::State_ptr& pt, MiniMC::CPA::proc_id proc,
+                                      MiniMC::CPA::Transferer_ptr transfer) {
+          auto loc = pt->getLocation(proc);
+          return Iterator(pt, proc, proc + 1, loc->ebegin(), loc->eend(), transfer);
+        }
+
+        static Iterator makeProcEnd(const MiniMC::CPA::State_ptr& pt, MiniMC::CPA::proc_id proc,
+                                    MiniMC::CPA::Transferer_ptr transfer) {
+          auto loc = pt->getLocation(proc);
+          return Iterator(pt, proc, proc + 1, loc->eend(), loc->eend(), transfer);
+        }
+
         Successor& operator*() { return succ; }
         Successor* operator->() { return &succ; }
 
@@ -118,7 +134,7 @@ namespace MiniMC {
 
     public:
       using iterator = Iterator;
-      Generator(MiniMC::CPA::Transferer_ptr& transfer) : transfer(transfer) {
+      Generator(MiniMC::CPA::Transferer_ptr& transfer, const PartialOrderReduction_ptr& por = nullptr) : transfer(transfer), por(por) {
       }
 
       auto begin_it(const MiniMC::CPA::State_ptr& state) {
@@ -131,12 +147,37 @@ namespace MiniMC {
 
       auto end_it(const MiniMC::CPA::State_ptr& state) { return Iterator::makeEnd(state, transfer); }
 
+      /**
+       * With partial order reduction, only the successors of the first
+       * process whose location has an ample set with an enabled edge
+       * are generated. Otherwise all successors are.
+       */
       auto generate(const MiniMC::CPA::State_ptr& state) {
+        if (por && state->nbOfProcesses() > 1) {
+          std::size_t outgoing = 0;
+          auto nbProcs = state->nbOfProcesses();
+          for (MiniMC::CPA::proc_id p = 0; p < nbProcs; ++p) {
+            outgoing += state->getLocation(p)->nbOutgoingEdges();
+          }
+          for (MiniMC::CPA::proc_id p = 0; p < nbProcs; ++p) {
+            auto loc = state->getLocation(p);
+            if (por->canReduceAt(loc.get())) {
+              auto begin = Iterator::makeProcBegin(state, p, transfer);
+              auto end = Iterator::makeProcEnd(state, p, transfer);
+              if (begin != end) {
+                por->record(loc->nbOutgoingEdges(), outgoing);
+                return std::make_pair(begin, end);
+              }
+            }
+          }
+          por->record(outgoing, outgoing);
+        }
         return std::make_pair(begin_it(state), end_it(state));
       }
 
     private:
       MiniMC::CPA::Transferer_ptr transfer;
+      PartialOrderReduction_ptr por;
     };
 
   } // namespace Algorithms
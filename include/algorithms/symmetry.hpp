@@ -0,0 +1,174 @@
+/**
+ * @file   symmetry.hpp
+ *
+ * @brief  Symmetry reduction for processes running the same function
+ *
+ *
+ */
+#ifndef _SYMMETRY__
+#define _SYMMETRY__
+
+#include "cpa/interface.hpp"
+#include "model/cfg.hpp"
+#include "support/feedback.hpp"
+#include "support/localisation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    /**
+     * Processes are interchangeable when their entry points start the
+     * same function. Every entry point gets its own wrapper function
+     * (see MiniMC::Model::createEntryPoint), so interchangeable
+     * processes run structurally equal wrappers, and a Location of one
+     * wrapper corresponds to the Location with the same ID in the
+     * other. All other Locations are shared by the processes.
+     *
+     * A State is canonicalised by sorting the processes of each class
+     * of interchangeable processes by their part of the State, so
+     * States that only differ in the order of those processes become
+     * equal. With N interchangeable processes this stores up to N!
+     * times fewer States.
+     */
+    class SymmetryReduction {
+    public:
+      SymmetryReduction(const MiniMC::Model::Program& prgm) {
+        auto& entries = prgm.getEntryPoints();
+        slots.resize(entries.size());
+        std::map<std::string, std::vector<MiniMC::CPA::proc_id>> candidates;
+        for (MiniMC::CPA::proc_id id = 0; id < entries.size(); ++id) {
+          auto& cfg = entries[id]->getCFG();
+          for (auto& loc : cfg->getLocations()) {
+            slots[id].emplace(loc->getID(), loc.get());
+            owner.emplace(loc.get(), loc->getID());
+          }
+          candidates[signature(*entries[id])].push_back(id);
+        }
+        for (auto& [sig, procs] : candidates) {
+          if (procs.size() > 1)
+            classes.push_back(procs);
+        }
+      }
+
+      /**
+       * @return the classes of interchangeable processes
+       */
+      auto& getClasses() const { return classes; }
+
+      /**
+       * @return true if the States of the CPA can be permuted. Checked
+       * on \p state, which all other States descend from.
+       */
+      bool supports(const MiniMC::CPA::State_ptr& state) const {
+        std::vector<MiniMC::CPA::proc_id> identity(slots.size());
+        std::iota(identity.begin(), identity.end(), 0);
+        try {
+          state->permute(identity, relocation());
+          return true;
+        } catch (MiniMC::Support::Exception&) {
+          return false;
+        }
+      }
+
+      /**
+       * @return the representative of the States equal to \p state up
+       * to the order of interchangeable processes
+       */
+      MiniMC::CPA::State_ptr canonical(const MiniMC::CPA::State_ptr& state) const {
+        if (!state || classes.empty())
+          return state;
+        std::vector<MiniMC::CPA::proc_id> perm(slots.size());
+        std::iota(perm.begin(), perm.end(), 0);
+        bool changed = false;
+        auto reloc = relocation();
+        for (auto& procs : classes) {
+          std::vector<std::pair<MiniMC::Hash::hash_t, MiniMC::CPA::proc_id>> keys;
+          for (auto id : procs)
+            keys.emplace_back(state->processHash(id, procs[0], reloc), id);
+          std::stable_sort(keys.begin(), keys.end(), [](auto& l, auto& r) { return l.first < r.first; });
+          for (std::size_t i = 0; i < procs.size(); ++i) {
+            perm[procs[i]] = keys[i].second;
+            changed |= keys[i].second != procs[i];
+          }
+        }
+        canonicalised++;
+        if (!changed)
+          return state;
+        permuted++;
+        return state->permute(perm, reloc);
+      }
+
+      std::size_t getCanonicalised() const { return canonicalised; }
+      std::size_t getPermuted() const { return permuted; }
+
+    private:
+      MiniMC::CPA::Relocation relocation() const {
+        return [this](MiniMC::Model::Location* loc, MiniMC::CPA::proc_id from, MiniMC::CPA::proc_id to) {
+          if (from == to)
+            return loc;
+          auto it = owner.find(loc);
+          if (it == owner.end())
+            return loc;
+          return slots[to].at(it->second);
+        };
+      }
+
+      /**
+       * Entry points with the same signature start the same function
+       * with structurally equal wrappers
+       */
+      static std::string signature(const MiniMC::Model::Function& entry) {
+        std::stringstream str;
+        auto& name = entry.getName();
+        str << name.substr(0, name.rfind('-')) << "\n";
+        auto& cfg = entry.getCFG();
+        for (auto& loc : cfg->getLocations())
+          str << loc->getID() << ";";
+        str << "\n";
+        for (auto& edge : cfg->getEdges())
+          str << edge->getFrom()->getID() << "->" << edge->getTo()->getID() << " " << *edge << "\n";
+        return str.str();
+      }
+
+      std::vector<std::vector<MiniMC::CPA::proc_id>> classes;
+      std::vector<std::unordered_map<MiniMC::offset_t, MiniMC::Model::Location*>> slots;
+      std::unordered_map<const MiniMC::Model::Location*, MiniMC::offset_t> owner;
+      mutable std::atomic<std::size_t> canonicalised = 0;
+      mutable std::atomic<std::size_t> permuted = 0;
+    };
+
+    using SymmetryReduction_ptr = std::shared_ptr<SymmetryReduction>;
+
+    /**
+     * Transferer that canonicalises the successors computed by \p inner
+     */
+    class SymmetricTransferer : public MiniMC::CPA::Transferer {
+    public:
+      SymmetricTransferer(const MiniMC::CPA::Transferer_ptr& inner, const SymmetryReduction_ptr& symmetry) : inner(inner), symmetry(symmetry) {}
+
+      MiniMC::CPA::State_ptr doTransfer(const MiniMC::CPA::State_ptr& s, const MiniMC::Model::Edge_ptr& e, MiniMC::CPA::proc_id id) override {
+        return symmetry->canonical(inner->doTransfer(s, e, id));
+      }
+
+    private:
+      MiniMC::CPA::Transferer_ptr inner;
+      SymmetryReduction_ptr symmetry;
+    };
+
+    inline void reportSymmetry(MiniMC::Support::Messager& mess, const SymmetryReduction_ptr& symmetry) {
+      if (!symmetry)
+        return;
+      mess.message(MiniMC::Support::Localiser("Symmetry reduction: %1% classes of interchangeable processes").format(symmetry->getClasses().size()));
+      mess.message(MiniMC::Support::Localiser("Symmetry reduction: %1% of %2% states permuted").format(symmetry->getPermuted(), symmetry->getCanonicalised()));
+    }
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
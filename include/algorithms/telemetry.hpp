@@ -0,0 +1,225 @@
+/**
+ * @file   telemetry.hpp
+ *
+ * @brief  Live counters of a running exploration
+ *
+ *
+ */
+#ifndef _TELEMETRY__
+#define _TELEMETRY__
+
+#include "support/feedback.hpp"
+#include "support/localisation.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    /**
+     * @return resident set size of this process in bytes, or 0 where
+     * it is unknown
+     */
+    inline std::size_t residentMemory() {
+#ifdef __linux__
+      std::ifstream statm("/proc/self/statm");
+      std::size_t size = 0, resident = 0;
+      if (statm >> size >> resident)
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+      return 0;
+    }
+
+    /**
+     * Counter that several threads add to. Each thread adds to its own
+     * stripe, so the increments do not contend for a cache line.
+     */
+    class StripedCounter {
+    public:
+      void add(std::size_t n = 1) { stripe().value.fetch_add(n, std::memory_order_relaxed); }
+
+      std::size_t value() const {
+        std::size_t res = 0;
+        for (auto& s : stripes)
+          res += s.value.load(std::memory_order_relaxed);
+        return res;
+      }
+
+    private:
+      static constexpr std::size_t nbStripes = 16;
+      struct alignas(64) Stripe {
+        std::atomic<std::size_t> value = 0;
+      };
+
+      Stripe& stripe() {
+        static std::atomic<std::size_t> nextThread = 0;
+        thread_local std::size_t index = nextThread++ % nbStripes;
+        return stripes[index];
+      }
+
+      Stripe stripes[nbStripes];
+    };
+
+    struct TelemetrySample {
+      double seconds = 0;            /**< Since the exploration started */
+      std::size_t explored = 0;      /**< States whose successors were generated */
+      std::size_t generated = 0;     /**< Successors produced by the transfer function */
+      std::size_t stored = 0;        /**< States added to the store */
+      std::size_t covered = 0;       /**< Successors dropped as covered by the store */
+      std::size_t joined = 0;        /**< Successors joined with a stored State */
+      std::size_t waiting = 0;       /**< States on the waiting list */
+      std::size_t rss = 0;           /**< Resident memory in bytes */
+      double transfersPerSecond = 0; /**< Since the previous sample */
+      double bytesPerState = 0;      /**< Memory grown since the start per stored State */
+    };
+
+    /**
+     * Counters of an exploration. The searches of the
+     * SimulationManager update the counters and call tick regularly;
+     * every interval, tick hands a TelemetrySample to the report
+     * function. All members may be used from several threads.
+     */
+    class Telemetry {
+    public:
+      using ReportFunction = std::function<void(const TelemetrySample&)>;
+
+      Telemetry(std::chrono::seconds interval, ReportFunction report) : interval(interval),
+                                                                        report(report),
+                                                                        start(std::chrono::steady_clock::now()),
+                                                                        next(start + interval),
+                                                                        last(start),
+                                                                        rssStart(residentMemory()) {}
+
+      StripedCounter explored;
+      StripedCounter generated;
+      StripedCounter stored;
+      StripedCounter covered;
+      StripedCounter joined;
+
+      /**
+       * Set the function reporting the size of the waiting list
+       */
+      void setWaiting(std::function<std::size_t()> func) {
+        std::scoped_lock lock(mutex);
+        waiting = func;
+      }
+
+      /**
+       * Report a sample if one is due. A thread that finds another
+       * thread reporting returns immediately.
+       */
+      void tick() {
+        if (interval.count() == 0 || std::chrono::steady_clock::now() < next)
+          return;
+        std::unique_lock lock(mutex, std::try_to_lock);
+        if (!lock)
+          return;
+        auto now = std::chrono::steady_clock::now();
+        if (now < next)
+          return;
+        next = now + interval;
+        auto s = makeSample(now);
+        if (report)
+          report(s);
+      }
+
+      /**
+       * @return sample of the whole exploration so far
+       */
+      TelemetrySample sample() {
+        std::scoped_lock lock(mutex);
+        auto res = makeSample(std::chrono::steady_clock::now());
+        res.transfersPerSecond = res.seconds > 0 ? res.generated / res.seconds : 0;
+        return res;
+      }
+
+    private:
+      TelemetrySample makeSample(std::chrono::steady_clock::time_point now) {
+        TelemetrySample res;
+        res.seconds = std::chrono::duration<double>(now - start).count();
+        res.explored = explored.value();
+        res.generated = generated.value();
+        res.stored = stored.value();
+        res.covered = covered.value();
+        res.joined = joined.value();
+        res.waiting = waiting ? waiting() : 0;
+        res.rss = residentMemory();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        res.transfersPerSecond = elapsed > 0 ? (res.generated - lastGenerated) / elapsed : 0;
+        res.bytesPerState = res.stored && res.rss > rssStart ? static_cast<double>(res.rss - rssStart) / res.stored : 0;
+        last = now;
+        lastGenerated = res.generated;
+        return res;
+      }
+
+      std::chrono::seconds interval;
+      ReportFunction report;
+      std::chrono::steady_clock::time_point start;
+      std::chrono::steady_clock::time_point next;
+      std::chrono::steady_clock::time_point last;
+      std::size_t lastGenerated = 0;
+      std::size_t rssStart;
+      std::function<std::size_t()> waiting;
+      std::mutex mutex;
+    };
+
+    using Telemetry_ptr = std::shared_ptr<Telemetry>;
+
+    inline std::string formatSample(const TelemetrySample& s) {
+      return MiniMC::Support::Localiser("%1%s: %2% states stored, %3% waiting, %4% transfers/s, %5% MB resident").format(static_cast<std::size_t>(s.seconds), s.stored, s.waiting, static_cast<std::size_t>(s.transfersPerSecond), s.rss >> 20);
+    }
+
+    /**
+     * Write \p s as JSON. A non-empty \p result, the outcome of the
+     * search, is written as the field "result".
+     */
+    inline void writeSample(std::ostream& os, const TelemetrySample& s, const std::string& result = "") {
+      os << std::fixed << std::setprecision(3)
+         << "{\n";
+      if (result.size())
+        os << "  \"result\": \"" << result << "\",\n";
+      os << "  \"seconds\": " << s.seconds << ",\n"
+         << "  \"explored\": " << s.explored << ",\n"
+         << "  \"generated\": " << s.generated << ",\n"
+         << "  \"stored\": " << s.stored << ",\n"
+         << "  \"covered\": " << s.covered << ",\n"
+         << "  \"joined\": " << s.joined << ",\n"
+         << "  \"waiting\": " << s.waiting << ",\n"
+         << "  \"transfers_per_second\": " << s.transfersPerSecond << ",\n"
+         << "  \"rss_bytes\": " << s.rss << ",\n"
+         << "  \"bytes_per_state\": " << s.bytesPerState << "\n"
+         << "}\n";
+    }
+
+    /**
+     * Report the final sample of \p telemetry and write it as JSON,
+     * with \p result, to \p file unless it is empty
+     */
+    inline void reportTelemetry(MiniMC::Support::Messager& messager, const Telemetry_ptr& telemetry, const std::string& file, const std::string& result = "") {
+      if (!telemetry)
+        return;
+      auto s = telemetry->sample();
+      messager.message(MiniMC::Support::Localiser("Explored %1% states, generated %2%, stored %3%, covered %4%, joined %5%").format(s.explored, s.generated, s.stored, s.covered, s.joined));
+      messager.message(MiniMC::Support::Localiser("%1% transfers/s, %2% MB resident, %3% bytes per stored state").format(static_cast<std::size_t>(s.transfersPerSecond), s.rss >> 20, static_cast<std::size_t>(s.bytesPerState)));
+      if (file.size()) {
+        std::ofstream os(file);
+        writeSample(os, s, result);
+        if (!os)
+          messager.warning(MiniMC::Support::Localiser("Could not write statistics to %1%").format(file));
+      }
+    }
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
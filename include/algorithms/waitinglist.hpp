@@ -0,0 +1,234 @@
+/**
+ * @file   waitinglist.hpp
+ *
+ * @brief  Waiting list of the SimulationManager
+ *
+ *
+ */
+#ifndef _WAITINGLIST__
+#define _WAITINGLIST__
+
+#include "cpa/interface.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    enum class SearchOrder {
+      DepthFirst,   /**< Newest State first */
+      BreadthFirst, /**< Oldest State first */
+      Priority      /**< State with highest priority first, newest first among equals */
+    };
+
+    /**
+     * Waiting list with a configurable exploration order. The
+     * depth/breadth first orders keep the States in a deque, the
+     * priority order in a binary heap.
+     *
+     * Replacing a waiting State (after it was joined with a new one)
+     * looks the State up in an index from State to position. The
+     * index is only built the first time replace is called, so
+     * searches that never join do not pay for it.
+     */
+    class WaitingList {
+    public:
+      /** Higher values are explored first */
+      using PriorityFunction = std::function<std::int64_t(const MiniMC::CPA::State_ptr&)>;
+
+      WaitingList(SearchOrder order = SearchOrder::DepthFirst, PriorityFunction prio = nullptr) : order(order), prio(std::move(prio)) {
+        assert(order != SearchOrder::Priority || this->prio);
+      }
+
+      std::size_t size() const { return order == SearchOrder::Priority ? heap.size() : states.size(); }
+      bool empty() const { return size() == 0; }
+
+      void push(const MiniMC::CPA::State_ptr& state) {
+        if (order == SearchOrder::Priority) {
+          heap.push_back({state, prio(state), nextSeq++});
+          if (indexed)
+            index[state.get()] = heap.size() - 1;
+          siftUp(heap.size() - 1);
+        } else {
+          states.push_back(state);
+          if (indexed)
+            index[state.get()] = first + states.size() - 1;
+        }
+      }
+
+      /**
+       * Remove and return the next State in the order of the list
+       */
+      MiniMC::CPA::State_ptr pop() {
+        assert(!empty());
+        MiniMC::CPA::State_ptr res;
+        switch (order) {
+          case SearchOrder::Priority:
+            res = std::move(heap.front().state);
+            if (heap.size() > 1)
+              moveEntry(heap.size() - 1, 0);
+            heap.pop_back();
+            if (heap.size())
+              siftDown(0);
+            break;
+          case SearchOrder::BreadthFirst:
+            res = std::move(states.front());
+            states.pop_front();
+            first++;
+            break;
+          case SearchOrder::DepthFirst:
+          default:
+            res = std::move(states.back());
+            states.pop_back();
+            break;
+        }
+        if (indexed)
+          index.erase(res.get());
+        return res;
+      }
+
+      /**
+       * Replace the waiting State \p orig by \p joined
+       *
+       * @return false if \p orig is not waiting
+       */
+      bool replace(const MiniMC::CPA::State_ptr& orig, const MiniMC::CPA::State_ptr& joined) {
+        if (!indexed)
+          buildIndex();
+        auto it = index.find(orig.get());
+        if (it == index.end())
+          return false;
+        auto pos = it->second;
+        index.erase(it);
+        index[joined.get()] = pos;
+        if (order == SearchOrder::Priority) {
+          heap[pos].state = joined;
+          heap[pos].priority = prio(joined);
+          siftDown(siftUp(pos));
+        } else {
+          states[pos - first] = joined;
+        }
+        return true;
+      }
+
+      /**
+       * Remove all States satisfying \p pred
+       *
+       * @return number of States removed
+       */
+      template <class Pred>
+      std::size_t remove_if(Pred pred) {
+        auto before = size();
+        if (order == SearchOrder::Priority) {
+          heap.erase(std::remove_if(heap.begin(), heap.end(), [&pred](const HeapEntry& e) { return pred(e.state); }), heap.end());
+          std::make_heap(heap.begin(), heap.end(), [](const HeapEntry& l, const HeapEntry& r) { return r.before(l); });
+        } else {
+          states.erase(std::remove_if(states.begin(), states.end(), pred), states.end());
+        }
+        if (indexed) {
+          index.clear();
+          buildIndex();
+        }
+        return before - size();
+      }
+
+      template <class Func>
+      void for_each(Func func) const {
+        for (auto& s : states)
+          func(s);
+        for (auto& e : heap)
+          func(e.state);
+      }
+
+      void clear() {
+        states.clear();
+        heap.clear();
+        index.clear();
+        first = 0;
+      }
+
+    private:
+      struct HeapEntry {
+        MiniMC::CPA::State_ptr state;
+        std::int64_t priority;
+        std::size_t seq;
+
+        bool before(const HeapEntry& oth) const {
+          return priority > oth.priority || (priority == oth.priority && seq > oth.seq);
+        }
+      };
+
+      void buildIndex() {
+        if (order == SearchOrder::Priority) {
+          for (std::size_t i = 0; i < heap.size(); ++i)
+            index[heap[i].state.get()] = i;
+        } else {
+          for (std::size_t i = 0; i < states.size(); ++i)
+            index[states[i].get()] = first + i;
+        }
+        indexed = true;
+      }
+
+      void moveEntry(std::size_t from, std::size_t to) {
+        if (from != to)
+          heap[to] = std::move(heap[from]);
+        if (indexed)
+          index[heap[to].state.get()] = to;
+      }
+
+      std::size_t siftUp(std::size_t pos) {
+        auto entry = std::move(heap[pos]);
+        while (pos > 0) {
+          auto parent = (pos - 1) / 2;
+          if (!entry.before(heap[parent]))
+            break;
+          moveEntry(parent, pos);
+          pos = parent;
+        }
+        heap[pos] = std::move(entry);
+        if (indexed)
+          index[heap[pos].state.get()] = pos;
+        return pos;
+      }
+
+      std::size_t siftDown(std::size_t pos) {
+        auto entry = std::move(heap[pos]);
+        for (;;) {
+          auto child = 2 * pos + 1;
+          if (child >= heap.size())
+            break;
+          if (child + 1 < heap.size() && heap[child + 1].before(heap[child]))
+            child++;
+          if (!heap[child].before(entry))
+            break;
+          moveEntry(child, pos);
+          pos = child;
+        }
+        heap[pos] = std::move(entry);
+        if (indexed)
+          index[heap[pos].state.get()] = pos;
+        return pos;
+      }
+
+      SearchOrder order;
+      PriorityFunction prio;
+      std::deque<MiniMC::CPA::State_ptr> states;
+      // Number of States ever popped from the front of states
+      std::size_t first = 0;
+      std::vector<HeapEntry> heap;
+      std::size_t nextSeq = 0;
+      bool indexed = false;
+      // Position of each waiting State: offset by first for states, heap index for heap
+      std::unordered_map<const MiniMC::CPA::State*, std::size_t> index;
+    };
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
@@ -0,0 +1,298 @@
+/**
+ * @file   workstealing.hpp
+ *
+ * @brief  Multi-threaded reachability search used by the SimulationManager
+ *
+ *
+ */
+#ifndef _WORKSTEALING__
+#define _WORKSTEALING__
+
+#include "algorithms/budget.hpp"
+#include "algorithms/successorgen.hpp"
+#include "algorithms/telemetry.hpp"
+#include "cpa/interface.hpp"
+#include "support/timing.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace MiniMC {
+  namespace Algorithms {
+
+    /**
+     * Passed set that can be shared between threads. States are
+     * distributed over shards by their hash value, and each shard is
+     * protected by its own lock. Since a State is only compared to
+     * the States of its own shard, the set is only usable for CPAs
+     * whose covering relation is equality.
+     */
+    class ConcurrentPassed {
+    public:
+      ConcurrentPassed(const MiniMC::CPA::Joiner_ptr& joiner, std::size_t nbShards) : joiner(joiner), shards(nbShards) {}
+
+      /**
+       * Insert \p state unless it is covered by a State already in the set
+       *
+       * @return true if \p state was inserted, false if it was covered
+       */
+      bool insert(const MiniMC::CPA::State_ptr& state) {
+        auto hash = state->hash();
+        auto& shard = shards[hash % shards.size()];
+        std::scoped_lock lock(shard.mutex);
+        auto range = shard.states.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+          if (joiner->covers(it->second, state))
+            return false;
+        }
+        shard.states.emplace(hash, state);
+        return true;
+      }
+
+      template <class Func>
+      void for_each(Func func) {
+        for (auto& shard : shards) {
+          std::scoped_lock lock(shard.mutex);
+          for (auto& it : shard.states)
+            func(it.second);
+        }
+      }
+
+    private:
+      struct Shard {
+        std::mutex mutex;
+        std::unordered_multimap<MiniMC::Hash::hash_t, MiniMC::CPA::State_ptr> states;
+      };
+      MiniMC::CPA::Joiner_ptr joiner;
+      std::vector<Shard> shards;
+    };
+
+    /**
+     * Per-thread counters of a WorkStealingSearch
+     */
+    struct ThreadStatistics {
+      std::size_t explored = 0; /**< States whose successors were generated */
+      std::size_t inserted = 0; /**< States put on the waiting list */
+      std::size_t steals = 0;   /**< States stolen from other threads */
+      double seconds = 0;       /**< Wall time the thread was running */
+    };
+
+    /**
+     * Reachability search with one waiting deque per thread. A thread
+     * works depth-first on the back of its own deque, and steals from
+     * the front of the deques of other threads when its own is empty.
+     * The search stops as soon as one of the threads finds a goal
+     * State, or when no thread has any work left.
+     */
+    class WorkStealingSearch {
+    public:
+      using FilterFunction = std::function<bool(const MiniMC::CPA::State_ptr&)>;
+
+      struct Options {
+        std::size_t threads;
+        std::function<bool(const MiniMC::CPA::State_ptr&)> storage;
+        MiniMC::CPA::Joiner_ptr joiner;
+        MiniMC::CPA::Transferer_ptr transfer;
+        PartialOrderReduction_ptr por;
+        FilterFunction filter;
+        FilterFunction delay;
+        FilterFunction goal;
+        Telemetry_ptr telemetry = nullptr;
+        BudgetGuard_ptr budget = nullptr; /**< Stops the search when exceeded */
+        std::size_t passed = 0;           /**< States counted against the budget before the search */
+      };
+
+      WorkStealingSearch(const Options& opt) : opt(opt),
+                                               passed(opt.joiner, opt.threads * 16),
+                                               workers(opt.threads),
+                                               stats(opt.threads) {}
+
+      /**
+       * Mark \p state as already passed without exploring it
+       */
+      void addPassed(const MiniMC::CPA::State_ptr& state) {
+        passed.insert(state);
+      }
+
+      /**
+       * Add \p state as starting point of the search.
+       */
+      void addWaiting(const MiniMC::CPA::State_ptr& state) {
+        auto& worker = workers[nextSeed++ % workers.size()];
+        pending++;
+        worker.deque.push_back(state);
+      }
+
+      /**
+       * Run the search with Options::threads threads
+       *
+       * @return the goal State found or nullptr if none was found.
+       */
+      MiniMC::CPA::State_ptr run() {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+          threads.emplace_back([this, i]() { work(i); });
+        }
+        for (auto& t : threads)
+          t.join();
+        if (error)
+          std::rethrow_exception(error);
+        return found;
+      }
+
+      /**
+       * Call \p func on all States left in the waiting deques
+       */
+      template <class Func>
+      void for_each_waiting(Func func) {
+        for (auto& worker : workers) {
+          for (auto& s : worker.deque)
+            func(s);
+        }
+      }
+
+      template <class Func>
+      void for_each_passed(Func func) {
+        passed.for_each(func);
+      }
+
+      const std::vector<ThreadStatistics>& getStatistics() const { return stats; }
+
+      /**
+       * @return number of States waiting or being explored
+       */
+      std::size_t getPending() const { return pending; }
+
+    private:
+      struct Worker {
+        std::mutex mutex;
+        std::deque<MiniMC::CPA::State_ptr> deque;
+      };
+
+      MiniMC::CPA::State_ptr pop(std::size_t id) {
+        auto& worker = workers[id];
+        std::scoped_lock lock(worker.mutex);
+        if (worker.deque.empty())
+          return nullptr;
+        auto res = worker.deque.back();
+        worker.deque.pop_back();
+        return res;
+      }
+
+      MiniMC::CPA::State_ptr steal(std::size_t id) {
+        for (std::size_t i = 1; i < workers.size(); ++i) {
+          auto& victim = workers[(id + i) % workers.size()];
+          std::scoped_lock lock(victim.mutex);
+          if (!victim.deque.empty()) {
+            auto res = victim.deque.front();
+            victim.deque.pop_front();
+            stats[id].steals++;
+            return res;
+          }
+        }
+        return nullptr;
+      }
+
+      void push(std::size_t id, const MiniMC::CPA::State_ptr& state) {
+        if (opt.storage(state)) {
+          if (!passed.insert(state)) {
+            if (opt.telemetry)
+              opt.telemetry->covered.add();
+            return;
+          }
+          if (opt.telemetry)
+            opt.telemetry->stored.add();
+        }
+        if (opt.delay(state))
+          return;
+        pending++;
+        stats[id].inserted++;
+        if (opt.budget && opt.budget->checkStates(opt.passed + inserted.fetch_add(1, std::memory_order_relaxed) + 1))
+          done = true;
+        auto& worker = workers[id];
+        std::scoped_lock lock(worker.mutex);
+        worker.deque.push_back(state);
+      }
+
+      void setFound(const MiniMC::CPA::State_ptr& state) {
+        std::scoped_lock lock(foundMutex);
+        if (!found)
+          found = state;
+        done = true;
+      }
+
+      void work(std::size_t id) {
+        MiniMC::Support::Phase phase("Search worker");
+        auto start = std::chrono::steady_clock::now();
+        try {
+          auto transfer = opt.transfer;
+          MiniMC::Algorithms::Generator generator(transfer, opt.por);
+          while (!done) {
+            auto cur = pop(id);
+            if (!cur)
+              cur = steal(id);
+            if (!cur) {
+              if (!pending)
+                break;
+              std::this_thread::yield();
+              continue;
+            }
+
+            // All successors are pushed even if the search stops
+            // meanwhile: cur counts as explored, so a checkpoint of the
+            // deques must hold all of them.
+            auto succs = generator.generate(cur);
+            for (auto it = succs.first; it != succs.second; ++it) {
+              if (opt.telemetry && it->state)
+                opt.telemetry->generated.add();
+              if (it->state && opt.filter(it->state)) {
+                if (opt.goal(it->state)) {
+                  setFound(it->state);
+                } else {
+                  push(id, it->state);
+                }
+              }
+            }
+            stats[id].explored++;
+            pending--;
+            if (opt.telemetry)
+              opt.telemetry->explored.add();
+            if (!(stats[id].explored % 256)) {
+              if (opt.telemetry)
+                opt.telemetry->tick();
+              if (opt.budget && opt.budget->checkResources())
+                done = true;
+            }
+          }
+        } catch (...) {
+          std::scoped_lock lock(foundMutex);
+          if (!error)
+            error = std::current_exception();
+          done = true;
+        }
+        stats[id].seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+
+      Options opt;
+      ConcurrentPassed passed;
+      std::vector<Worker> workers;
+      std::vector<ThreadStatistics> stats;
+      std::atomic<std::size_t> pending = 0;
+      std::atomic<std::size_t> inserted = 0;
+      std::atomic<bool> done = false;
+      std::size_t nextSeed = 0;
+      std::mutex foundMutex;
+      MiniMC::CPA::State_ptr found = nullptr;
+      std::exception_ptr error = nullptr;
+    };
+
+  } // namespace Algorithms
+} // namespace MiniMC
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * @file   approximate.hpp
+ *
+ * @brief  Storers that only keep a fingerprint of the visited States
+ *
+ * They trade completeness for memory: two different States with the
+ * same fingerprint are taken to be equal, so parts of the state space
+ * may be missed. They are only sound to use for CPAs whose covering
+ * relation is equality.
+ */
+#ifndef _CPA_APPROXIMATE__
+#define _CPA_APPROXIMATE__
+
+#include "cpa/collapse.hpp"
+#include "cpa/external.hpp"
+#include "cpa/interface.hpp"
+#include "support/exceptions.hpp"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace MiniMC {
+  namespace CPA {
+
+    /**
+     * Base class for storers that keep fingerprints instead of States.
+     * Since the States are not kept, loadState is not supported and
+     * isCoveredByStore returns the queried State itself when it has
+     * been seen before.
+     */
+    class ApproximateStorer : public IStorer {
+    public:
+      State_ptr loadState(StorageTag) override {
+        throw MiniMC::Support::Exception("Approximate storage cannot load states");
+      }
+
+      IStorer::JoinPair joinState(const State_ptr& state) override {
+        saveState(state);
+        return {.orig = nullptr, .joined = nullptr};
+      }
+
+      State_ptr isCoveredByStore(const State_ptr& state) override {
+        return contains(state->hash()) ? state : nullptr;
+      }
+
+      bool saveState(const State_ptr& state, StorageTag* tag = nullptr) override {
+        auto hash = state->hash();
+        if (tag)
+          *tag = hash;
+        if (insert(hash))
+          nbStored++;
+        return true;
+      }
+
+      IStorer::Iterator stored_begin() override { return empty.begin(); }
+      IStorer::Iterator stored_end() override { return empty.end(); }
+
+      /**
+       * @return number of States saved
+       */
+      std::size_t stored() const { return nbStored; }
+
+      /**
+       * @return Estimate of the probability that at least one of the
+       * saved States would have been wrongly considered visited, so
+       * that part of the state space was missed. The estimate is over
+       * all saved States, not only the last one.
+       */
+      virtual double omissionProbability() const = 0;
+
+      /**
+       * @return Memory used for the fingerprints in bytes
+       */
+      virtual std::size_t memory() const = 0;
+
+    protected:
+      virtual bool contains(MiniMC::Hash::hash_t) const = 0;
+      virtual bool insert(MiniMC::Hash::hash_t) = 0;
+
+    private:
+      std::size_t nbStored = 0;
+      std::vector<State_ptr> empty;
+    };
+
+    /**
+     * Stores a 64 bit fingerprint per State in an open addressing
+     * table of fixed size. When the table is full, further States
+     * are dropped, and from then on every State not in the table is
+     * treated as visited. The search therefore still terminates, but
+     * may miss States.
+     */
+    class HashCompactionStorer : public ApproximateStorer {
+    public:
+      HashCompactionStorer(std::size_t bytes) : table(std::max<std::size_t>(bytes / sizeof(MiniMC::Hash::hash_t), 1), 0) {}
+
+      /**
+       * 1 once States were dropped. Otherwise the birthday bound on
+       * two of the stored States sharing a fingerprint.
+       */
+      double omissionProbability() const override {
+        if (dropped)
+          return 1;
+        double n = stored();
+        return -std::expm1(-(n * n) / std::ldexp(1.0, 65));
+      }
+
+      std::size_t memory() const override { return table.size() * sizeof(MiniMC::Hash::hash_t); }
+
+      /**
+       * @return number of States that did not fit in the table
+       */
+      std::size_t getDropped() const { return dropped; }
+
+    protected:
+      bool contains(MiniMC::Hash::hash_t hash) const override {
+        auto fp = fingerprint(hash);
+        for (std::size_t i = 0, pos = fp % table.size(); i < table.size(); ++i, pos = (pos + 1) % table.size()) {
+          if (table[pos] == fp)
+            return true;
+          if (!table[pos])
+            return dropped > 0;
+        }
+        return dropped > 0;
+      }
+
+      bool insert(MiniMC::Hash::hash_t hash) override {
+        if (used + 1 >= table.size()) {
+          dropped++;
+          return false;
+        }
+        auto fp = fingerprint(hash);
+        auto pos = fp % table.size();
+        while (table[pos]) {
+          if (table[pos] == fp)
+            return false;
+          pos = (pos + 1) % table.size();
+        }
+        table[pos] = fp;
+        used++;
+        return true;
+      }
+
+    private:
+      // 0 marks an empty slot
+      static MiniMC::Hash::hash_t fingerprint(MiniMC::Hash::hash_t hash) { return hash ? hash : 1; }
+
+      std::vector<MiniMC::Hash::hash_t> table;
+      std::size_t used = 0;
+      std::size_t dropped = 0;
+    };
+
+    /**
+     * Bitstate hashing: each State sets \p k bits in a bit array. A
+     * State is considered visited if all its bits are set.
+     */
+    class BitStateStorer : public ApproximateStorer {
+    public:
+      BitStateStorer(std::size_t bytes, std::size_t k = 3) : bits(std::max<std::size_t>(bytes, 1) * 8, false), k(k) {}
+
+      /**
+       * 1 - prod (1 - p_i), where p_i is the probability that the
+       * i'th saved State found all its bits set already, given the
+       * fraction of the bit array set when it was saved.
+       */
+      double omissionProbability() const override {
+        return -std::expm1(logNoOmission);
+      }
+
+      std::size_t memory() const override { return bits.size() / 8; }
+
+    protected:
+      bool contains(MiniMC::Hash::hash_t hash) const override {
+        for (std::size_t i = 0; i < k; ++i) {
+          if (!bits[bit(hash, i)])
+            return false;
+        }
+        return true;
+      }
+
+      bool insert(MiniMC::Hash::hash_t hash) override {
+        logNoOmission += std::log1p(-std::pow(static_cast<double>(set) / bits.size(), k));
+        bool isNew = false;
+        for (std::size_t i = 0; i < k; ++i) {
+          auto b = bit(hash, i);
+          if (!bits[b]) {
+            isNew = true;
+            bits[b] = true;
+            set++;
+          }
+        }
+        return isNew;
+      }
+
+    private:
+      // Double hashing: the i'th bit is h1 + i*h2
+      std::size_t bit(MiniMC::Hash::hash_t hash, std::size_t i) const {
+        auto h2 = MiniMC::Hash::Hash(&hash, 1, 0x9e3779b97f4a7c15ull) | 1;
+        return (hash + i * h2) % bits.size();
+      }
+
+      std::vector<bool> bits;
+      std::size_t k;
+      std::size_t set = 0;
+      // log of the probability that no saved State was omitted
+      double logNoOmission = 0;
+    };
+
+    enum class StorageMode {
+      Exact,
+      HashCompaction,
+      BitState,
+      External,
+      Collapse /**< Exact, but equal components of States are shared */
+    };
+
+    /**
+     * Wraps a CPA and replaces its storer by an approximate one of at
+     * most \p bytes, or by a CollapseStorer. CPAs whose covering is
+     * not equality (i.e. that do not store in a HashStorer) keep their
+     * own storer. External storage keeps its scratch files in \p dir.
+     */
+    class ApproximateStorageCPA : public ICPA {
+    public:
+      ApproximateStorageCPA(const CPA_ptr& cpa, StorageMode mode, std::size_t bytes, const std::string& dir = "") : cpa(cpa), mode(mode), bytes(bytes), dir(dir) {}
+
+      StateQuery_ptr makeQuery() const override { return cpa->makeQuery(); }
+      Transferer_ptr makeTransfer() const override { return cpa->makeTransfer(); }
+      Joiner_ptr makeJoin() const override { return cpa->makeJoin(); }
+      PrevalidateSetup_ptr makeValidate() const override { return cpa->makeValidate(); }
+
+      Storer_ptr makeStore() const override {
+        auto store = cpa->makeStore();
+        if (!std::dynamic_pointer_cast<HashStorer>(store))
+          return store;
+        switch (mode) {
+          case StorageMode::HashCompaction:
+            return std::make_shared<HashCompactionStorer>(bytes);
+          case StorageMode::BitState:
+            return std::make_shared<BitStateStorer>(bytes);
+          case StorageMode::External:
+            return std::make_shared<ExternalStorer>(bytes, dir.size() ? std::filesystem::path(dir) : std::filesystem::temp_directory_path());
+          case StorageMode::Collapse:
+            return std::make_shared<CollapseStorer>(cpa->makeJoin());
+          case StorageMode::Exact:
+          default:
+            return store;
+        }
+      }
+
+      const CPA_ptr& getCPA() const { return cpa; }
+      StorageMode getMode() const { return mode; }
+
+    private:
+      CPA_ptr cpa;
+      StorageMode mode;
+      std::size_t bytes;
+      std::string dir;
+    };
+
+  } // namespace CPA
+} // namespace MiniMC
+
+#endif
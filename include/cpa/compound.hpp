@@ -3,69 +3,54 @@
 
 #include "cpa/interface.hpp"
 #include "hash/hashing.hpp"
+#include <algorithm>
+#include <array>
 #include <initializer_list>
 #include <set>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace MiniMC {
   namespace CPA {
     namespace Compounds {
-      class State : public MiniMC::CPA::State {
+      /**
+       * The State operations of a compound state, applied to each
+       * component in turn. Derived names the component asked for a
+       * Concretizer with concretizing() and builds itself from new
+       * components with make().
+       */
+      template <class Derived, class Container>
+      class ComponentStates : public MiniMC::CPA::State {
       public:
-        State(std::initializer_list<MiniMC::CPA::State_ptr> l) {
-          std::copy(l.begin(), l.end(), std::back_inserter(states));
-        }
-
-        State(std::vector<MiniMC::CPA::State_ptr>& l) {
-          std::copy(l.begin(), l.end(), std::back_inserter(states));
-        }
+        ComponentStates(Container&& c) : states(std::move(c)) {}
 
         virtual MiniMC::Hash::hash_t hash(MiniMC::Hash::seed_t seed = 0) const override {
           MiniMC::Hash::hash_t hash = seed;
-
           for (auto& state : states) {
             MiniMC::Hash::hash_combine(hash, *state);
           }
           return hash;
         }
 
-        bool need2Store() const {
-          for (auto& state : states) {
-            if (state->need2Store()) {
-              return true;
-            }
-          }
-          return false;
+        bool need2Store() const override {
+          return std::any_of(states.begin(), states.end(), [](auto& s) { return s->need2Store(); });
         }
 
-        virtual bool assertViolated() const {
-          for (auto& state : states) {
-            if (state->assertViolated()) {
-              return true;
-            }
-          }
-          return false;
+        bool assertViolated() const override {
+          return std::any_of(states.begin(), states.end(), [](auto& s) { return s->assertViolated(); });
         }
 
-        virtual bool hasLocationAttribute(MiniMC::Model::AttrType tt) const {
-          for (auto& state : states) {
-            if (state->hasLocationAttribute(tt)) {
-              return true;
-            }
-          }
-          return false;
+        bool hasLocationAttribute(MiniMC::Model::AttrType tt) const override {
+          return std::any_of(states.begin(), states.end(), [tt](auto& s) { return s->hasLocationAttribute(tt); });
         }
 
         bool ready2explore() const override {
-          for (auto& state : states) {
-            if (!state->ready2explore()) {
-              return false;
-            }
-          }
-          return true;
+          return std::all_of(states.begin(), states.end(), [](auto& s) { return s->ready2explore(); });
         }
 
-        virtual std::ostream& output(std::ostream& os) const {
+        virtual std::ostream& output(std::ostream& os) const override {
           for (auto& state : states) {
             state->output(os);
             os << "\n________________\n";
@@ -76,94 +61,102 @@ namespace MiniMC {
         const State_ptr& get(size_t i) const { return states[i]; }
 
         virtual const Concretizer_ptr getConcretizer() const override {
-
-          return this->get(1)->getConcretizer();
-          //return Concretizer_ptr (this);
+          return states[static_cast<const Derived&>(*this).concretizing()]->getConcretizer();
         }
 
-        virtual std::shared_ptr<MiniMC::CPA::State> copy() const {
-          std::vector<MiniMC::CPA::State_ptr> copies;
-          std::for_each(states.begin(), states.end(), [&](auto& s) { copies.push_back(s->copy()); });
-          return std::make_shared<State>(copies);
+        virtual std::shared_ptr<MiniMC::CPA::State> copy() const override {
+          return map([](auto& s) { return s->copy(); });
         }
 
         virtual MiniMC::Model::Location_ptr getLocation(proc_id id) const override {
-          return this->get(0)->getLocation(id);
+          return states[0]->getLocation(id);
         }
 
         size_t nbOfProcesses() const override {
-          return this->get(0)->nbOfProcesses();
+          return states[0]->nbOfProcesses();
         }
 
-      private:
-        std::vector<MiniMC::CPA::State_ptr> states;
-      };
+        /**
+         * The components are written in order without a count; the
+         * StateQuery knows how many there are.
+         */
+        void serialize(MiniMC::Support::Writer& writer) const override {
+          for (auto& state : states)
+            state->serialize(writer);
+        }
 
-      /* template<unsigned int N, class Head, class... Tail>
-      struct GetNthTemplateArgument : GetNthTemplateArgument<N-1,Tail...>
-      {
+        void intern(MiniMC::CPA::Interner& interner) override {
+          for (auto& state : states)
+            state->intern(interner);
+        }
+
+        MiniMC::Hash::hash_t processHash(proc_id id, proc_id as, const Relocation& reloc) const override {
+          MiniMC::Hash::hash_t hash = 0;
+          for (auto& state : states)
+            MiniMC::Hash::hash_combine(hash, state->processHash(id, as, reloc));
+          return hash;
+        }
+
+        std::shared_ptr<MiniMC::CPA::State> permute(const std::vector<proc_id>& perm, const Relocation& reloc) const override {
+          return map([&](auto& s) { return s->permute(perm, reloc); });
+        }
+
+      protected:
+        template <class F>
+        std::shared_ptr<MiniMC::CPA::State> map(F f) const {
+          Container res = states;
+          std::transform(states.begin(), states.end(), res.begin(), f);
+          return static_cast<const Derived&>(*this).make(std::move(res));
+        }
+
+        Container states;
       };
 
+      /**
+       * Compound State with any number of components. Component \p ask
+       * provides the Concretizer.
+       */
+      class State : public ComponentStates<State, std::vector<MiniMC::CPA::State_ptr>> {
+      public:
+        State(std::initializer_list<MiniMC::CPA::State_ptr> l, std::size_t ask = 1) : ComponentStates(std::vector<MiniMC::CPA::State_ptr>(l)), ask(ask) {}
+
+        State(std::vector<MiniMC::CPA::State_ptr> l, std::size_t ask = 1) : ComponentStates(std::move(l)), ask(ask) {}
 
-      template<class Head, class... Tail>
-      struct GetNthTemplateArgument<0,Head,Tail...>
-      {
-	using Temp = Head;;
+        std::size_t concretizing() const { return ask; }
+
+        std::shared_ptr<MiniMC::CPA::State> make(std::vector<MiniMC::CPA::State_ptr>&& c) const {
+          return std::make_shared<State>(std::move(c), ask);
+        }
+
+      private:
+        std::size_t ask;
       };
-      */
+
       struct StateQuery : public MiniMC::CPA::StateQuery {
-        StateQuery(std::vector<MiniMC::CPA::StateQuery_ptr> pts) : states(pts) {}
+        StateQuery(std::vector<MiniMC::CPA::StateQuery_ptr> pts, std::size_t ask) : states(pts), ask(ask) {}
         State_ptr makeInitialState(const MiniMC::Model::Program& prgm) {
-          //std::initializer_list<MiniMC::CPA::State_ptr> init ( {(args::Query::makeInitialState (prgm)) ...});
-          //return std::make_shared<State<sizeof... (args)>> (init);
           std::vector<MiniMC::CPA::State_ptr> statees;
           auto inserter = std::back_inserter(statees);
           std::for_each(states.begin(), states.end(), [&inserter, &prgm](auto& it) { inserter = (it->makeInitialState(prgm)); });
-          return std::make_shared<State>(statees);
+          return std::make_shared<State>(statees, ask);
+        }
+
+        State_ptr deserialize(MiniMC::Support::Reader& reader, const MiniMC::Model::Program& prgm) override {
+          std::vector<MiniMC::CPA::State_ptr> statees;
+          for (auto& query : states)
+            statees.push_back(query->deserialize(reader, prgm));
+          return std::make_shared<State>(statees, ask);
         }
 
       private:
         std::vector<MiniMC::CPA::StateQuery_ptr> states;
+        std::size_t ask;
       };
 
-      /*template<size_t i, size_t statesize, class A, class ... args>
-      struct BuildVector {
-	static void doIt (std::vector<MiniMC::CPA::State_ptr>& vec,const State<statesize>& s, const MiniMC::Model::Edge_ptr& e,proc_id id) {
-	  vec.push_back (A::Transfer::doTransfer (s.template get<i> (),e,id));
-	  BuildVector<i+1,statesize,args...>::doIt (vec,s,e,id);
-	}
-      };
-
-      template<size_t i, size_t statesize, class A>
-      struct BuildVector<i,statesize,A> {
-	static void doIt (std::vector<MiniMC::CPA::State_ptr>& vec,const State<statesize>& s, const MiniMC::Model::Edge_ptr& e,proc_id id) {
-	  vec.push_back (A::Transfer::doTransfer (s.template get<i> (),e,id));
-	}
-	};*/
-
       struct Transferer : public MiniMC::CPA::Transferer {
         Transferer(std::vector<MiniMC::CPA::Transferer_ptr> pts) : transfers(pts) {}
-        /*template<size_t i, class Inserter>
-	  static bool buildVector (Inserter& ins, const State<sizeof...(args)>& s, const MiniMC::Model::Edge_ptr& e,proc_id id) {
-	  static_assert(i <= sizeof... (args));
-	  if constexpr (i == sizeof... (args)) {
-	    return true; //We are done
-	  }
-	  else {
-	    using A = typename GetNthTemplateArgument<i,args...>::Temp;
-	    auto res = A::Transfer::doTransfer (s.template get<i> (),e,id);
-	    if (res) {
-	      ins = res;
-	      return buildVector<i+1,Inserter> (ins,s,e,id);
-	    }
-	    else
-	      return false;
-	  }
-		
-	}
-	*/
         State_ptr doTransfer(const State_ptr& a, const MiniMC::Model::Edge_ptr& e, proc_id id) {
-          auto s = static_cast<State&>(*a);
+          auto& s = static_cast<const State&>(*a);
           auto n = transfers.size();
           std::vector<MiniMC::CPA::State_ptr> vec;
           for (size_t i = 0; i < n; i++) {
@@ -173,7 +166,7 @@ namespace MiniMC {
             }
             vec.push_back(res);
           }
-          return std::make_shared<State>(vec);
+          return s.make(std::move(vec));
         }
 
         std::vector<MiniMC::CPA::Transferer_ptr> transfers;
@@ -183,8 +176,8 @@ namespace MiniMC {
         Joiner(std::vector<MiniMC::CPA::Joiner_ptr> pts) : joiners(pts) {}
 
         State_ptr doJoin(const State_ptr& l, const State_ptr& r) {
-          auto left = static_cast<State&>(*l);
-          auto right = static_cast<State&>(*r);
+          auto& left = static_cast<const State&>(*l);
+          auto& right = static_cast<const State&>(*r);
           auto n = joiners.size();
           std::vector<MiniMC::CPA::State_ptr> vec;
           for (size_t i = 0; i < n; i++) {
@@ -194,36 +187,12 @@ namespace MiniMC {
             }
             vec.push_back(res);
           }
-          return std::make_shared<State>(vec);
-        }
-
-        /*template<size_t i>
-	static bool checkCovers (const State<sizeof...(Args)>& l, const State<sizeof...(Args)>& r) {
-	  static_assert(i <= sizeof... (Args));
-	  if constexpr (i == sizeof... (Args)) {
-	    return true; //We are done
-	  }
-	  else {
-	    using A = typename GetNthTemplateArgument<i,Args...>::Temp;
-	    auto left = l.template get<i> ();
-	    auto right = r.template get<i> ();
-	    
-			
-	    if (A::Join::covers (left,right)) {
-	      return checkCovers<i+1> (l,r);
-	    }
-	    else {
-	      return false;
-	    }
-	  }
-	  }*/
+          return left.make(std::move(vec));
+        }
 
         bool covers(const State_ptr& l, const State_ptr& r) {
-          /*auto left = static_cast<State<sizeof... (Args)>&> (*l);
-	  auto right = static_cast<State<sizeof... (Args)>&> (*r);
-	  return checkCovers<0> (left,right);*/
-          auto left = static_cast<State&>(*l);
-          auto right = static_cast<State&>(*r);
+          auto& left = static_cast<const State&>(*l);
+          auto& right = static_cast<const State&>(*r);
           auto n = joiners.size();
           for (size_t i = 0; i < n; i++) {
             auto res = joiners[i]->covers(left.get(i), right.get(i));
@@ -241,32 +210,25 @@ namespace MiniMC {
       struct PreValidateSetup : public MiniMC::CPA::PrevalidateSetup {
 
         bool validate(const MiniMC::Model::Program& prgm, MiniMC::Support::Messager& mess) {
-          /*A::PreValidate::validate (prgm,mess);
-	    return PreValidateSetup<CPAs...>::validate (prgm,mess);*/
           return true;
         }
       };
 
-      /*template<size_t ask,class... CPAs>
-      struct CPADef {
-	using Query = StateQuery<ask,CPAs...>;
-	using Transfer = Transferer<CPAs...>;
-	using Join = Joiner<CPAs...>;
-	using Storage = Storer<Join>;
-	using PreValidate = PreValidateSetup<CPAs...>;
-	};*/
-
+      /**
+       * Compound of CPAs chosen at run time. Component \p ask
+       * provides the Concretizer of the compound states.
+       */
       struct CPA : public MiniMC::CPA::ICPA {
-        CPA(std::vector<MiniMC::CPA::CPA_ptr>& p) : cpas(p) {
+        CPA(std::vector<MiniMC::CPA::CPA_ptr>& p, std::size_t ask = 1) : cpas(p), ask(ask) {
         }
 
-        CPA(std::initializer_list<MiniMC::CPA::CPA_ptr> p) {
+        CPA(std::initializer_list<MiniMC::CPA::CPA_ptr> p, std::size_t ask = 1) : ask(ask) {
           std::copy(p.begin(), p.end(), std::back_inserter(cpas));
         }
         virtual MiniMC::CPA::StateQuery_ptr makeQuery() const {
           std::vector<StateQuery_ptr> queries;
           std::for_each(cpas.begin(), cpas.end(), [&queries](auto& it) { queries.push_back(it->makeQuery()); });
-          return std::make_shared<StateQuery>(queries);
+          return std::make_shared<StateQuery>(queries, ask);
         }
         virtual MiniMC::CPA::Transferer_ptr makeTransfer() const {
           std::vector<Transferer_ptr> transfers;
@@ -279,7 +241,17 @@ namespace MiniMC {
           return std::make_shared<Joiner>(joiners);
         }
 
+        /** 
+         * If all component CPAs store their states in a HashStorer,
+         * then covering is equality on all components and the
+         * compound states can be stored in a HashStorer as well. 
+         */
         virtual MiniMC::CPA::Storer_ptr makeStore() const {
+          bool hashable = std::all_of(cpas.begin(), cpas.end(), [](auto& it) {
+            return std::dynamic_pointer_cast<MiniMC::CPA::HashStorer>(it->makeStore()) != nullptr;
+          });
+          if (hashable)
+            return std::make_shared<MiniMC::CPA::HashStorer>(makeJoin());
           return std::make_shared<MiniMC::CPA::Storer>(makeJoin());
         }
 
@@ -289,6 +261,156 @@ namespace MiniMC {
 
       private:
         std::vector<MiniMC::CPA::CPA_ptr> cpas;
+        std::size_t ask;
+      };
+
+      /**
+       * Compound State with a fixed number of components. The
+       * components are kept in a std::array so its layout is known at
+       * compile time. Component \p ask provides the Concretizer.
+       */
+      template <std::size_t ask, class... CPAs>
+      class FixedState : public ComponentStates<FixedState<ask, CPAs...>, std::array<MiniMC::CPA::State_ptr, sizeof...(CPAs)>> {
+      public:
+        static constexpr std::size_t Size = sizeof...(CPAs);
+        static_assert(ask < Size, "ask must name a component");
+        using Components = std::array<MiniMC::CPA::State_ptr, Size>;
+
+        FixedState(Components&& c) : ComponentStates<FixedState, Components>(std::move(c)) {}
+
+        static constexpr std::size_t concretizing() { return ask; }
+
+        std::shared_ptr<MiniMC::CPA::State> make(Components&& c) const {
+          return std::make_shared<FixedState>(std::move(c));
+        }
+      };
+
+      /**
+       * Compound CPA whose components are fixed at compile time. The
+       * operations of the component CPAs are held by value and called
+       * without virtual dispatch, and successors are built directly in
+       * a FixedState whose Concretizer is that of component \p ask.
+       */
+      template <std::size_t ask, class... CPAs>
+      struct Compound : public MiniMC::CPA::ICPA {
+        using CState = FixedState<ask, CPAs...>;
+        using Indexes = std::index_sequence_for<CPAs...>;
+
+        struct StateQuery : public MiniMC::CPA::StateQuery {
+          State_ptr makeInitialState(const MiniMC::Model::Program& prgm) override {
+            return make(prgm, Indexes{});
+          }
+
+          State_ptr deserialize(MiniMC::Support::Reader& reader, const MiniMC::Model::Program& prgm) override {
+            return read(reader, prgm, Indexes{});
+          }
+
+        private:
+          template <std::size_t I>
+          using QueryAt = std::tuple_element_t<I, std::tuple<typename CPAs::QueryType...>>;
+
+          template <std::size_t... I>
+          State_ptr make(const MiniMC::Model::Program& prgm, std::index_sequence<I...>) {
+            return std::make_shared<CState>(typename CState::Components{
+                std::get<I>(queries).QueryAt<I>::makeInitialState(prgm)...});
+          }
+
+          // Braced initialisation evaluates the components in order
+          template <std::size_t... I>
+          State_ptr read(MiniMC::Support::Reader& reader, const MiniMC::Model::Program& prgm, std::index_sequence<I...>) {
+            return std::make_shared<CState>(typename CState::Components{
+                std::get<I>(queries).QueryAt<I>::deserialize(reader, prgm)...});
+          }
+
+          std::tuple<typename CPAs::QueryType...> queries;
+        };
+
+        struct Transferer : public MiniMC::CPA::Transferer {
+          State_ptr doTransfer(const State_ptr& a, const MiniMC::Model::Edge_ptr& e, proc_id id) override {
+            auto& s = static_cast<const CState&>(*a);
+            typename CState::Components res;
+            if (transferAll(res, s, e, id, Indexes{}))
+              return std::make_shared<CState>(std::move(res));
+            return nullptr;
+          }
+
+        private:
+          template <std::size_t I>
+          bool transferOne(typename CState::Components& res, const CState& s, const MiniMC::Model::Edge_ptr& e, proc_id id) {
+            using T = std::tuple_element_t<I, std::tuple<typename CPAs::TransferType...>>;
+            res[I] = std::get<I>(transfers).T::doTransfer(s.get(I), e, id);
+            return res[I] != nullptr;
+          }
+
+          template <std::size_t... I>
+          bool transferAll(typename CState::Components& res, const CState& s, const MiniMC::Model::Edge_ptr& e, proc_id id, std::index_sequence<I...>) {
+            return (transferOne<I>(res, s, e, id) && ...);
+          }
+
+          std::tuple<typename CPAs::TransferType...> transfers;
+        };
+
+        struct Joiner : public MiniMC::CPA::Joiner {
+          State_ptr doJoin(const State_ptr& l, const State_ptr& r) override {
+            auto& left = static_cast<const CState&>(*l);
+            auto& right = static_cast<const CState&>(*r);
+            typename CState::Components res;
+            if (joinAll(res, left, right, Indexes{}))
+              return std::make_shared<CState>(std::move(res));
+            return nullptr;
+          }
+
+          bool covers(const State_ptr& l, const State_ptr& r) override {
+            return coversAll(static_cast<const CState&>(*l), static_cast<const CState&>(*r), Indexes{});
+          }
+
+        private:
+          template <std::size_t I>
+          using JoinAt = std::tuple_element_t<I, std::tuple<typename CPAs::JoinType...>>;
+
+          template <std::size_t I>
+          bool joinOne(typename CState::Components& res, const CState& l, const CState& r) {
+            res[I] = std::get<I>(joiners).JoinAt<I>::doJoin(l.get(I), r.get(I));
+            return res[I] != nullptr;
+          }
+
+          template <std::size_t... I>
+          bool joinAll(typename CState::Components& res, const CState& l, const CState& r, std::index_sequence<I...>) {
+            return (joinOne<I>(res, l, r) && ...);
+          }
+
+          template <std::size_t... I>
+          bool coversAll(const CState& l, const CState& r, std::index_sequence<I...>) {
+            return (std::get<I>(joiners).JoinAt<I>::covers(l.get(I), r.get(I)) && ...);
+          }
+
+          std::tuple<typename CPAs::JoinType...> joiners;
+        };
+
+        struct PreValidateSetup : public MiniMC::CPA::PrevalidateSetup {
+          bool validate(const MiniMC::Model::Program& prgm, MiniMC::Support::Messager& mess) override {
+            return (typename CPAs::PrevalidateType{}.validate(prgm, mess) && ...);
+          }
+        };
+
+        virtual MiniMC::CPA::StateQuery_ptr makeQuery() const override { return std::make_shared<StateQuery>(); }
+        virtual MiniMC::CPA::Transferer_ptr makeTransfer() const override { return std::make_shared<Transferer>(); }
+        virtual MiniMC::CPA::Joiner_ptr makeJoin() const override { return std::make_shared<Joiner>(); }
+
+        /** 
+         * Same rule as the dynamic CPA: the compound uses a HashStorer
+         * if all components do. 
+         */
+        virtual MiniMC::CPA::Storer_ptr makeStore() const override {
+          if constexpr ((std::is_same_v<typename CPAs::StoreType, MiniMC::CPA::HashStorer> && ...))
+            return std::make_shared<MiniMC::CPA::HashStorer>(makeJoin());
+          else
+            return std::make_shared<MiniMC::CPA::Storer>(makeJoin());
+        }
+
+        virtual MiniMC::CPA::PrevalidateSetup_ptr makeValidate() const override {
+          return std::make_shared<PreValidateSetup>();
+        }
       };
 
     } // namespace Compounds
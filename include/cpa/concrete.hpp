@@ -24,18 +24,33 @@ namespace MiniMC {
         size_t nbOfProcesses(const MiniMC::CPA::State_ptr&) { return 0; }
 
         MiniMC::Model::Location_ptr getLocation(const MiniMC::CPA::State_ptr&, proc_id id) { return nullptr; }
+
+        MiniMC::CPA::State_ptr deserialize(MiniMC::Support::Reader&, const MiniMC::Model::Program&) override;
       };
 
+      class DecodeCache;
+
+      /**
+       * Executes the InstructionStreams of edges. Each stream is
+       * decoded once and the decoded form is reused by later
+       * transfers along the same edge.
+       */
       struct Transferer : public MiniMC::CPA::Transferer {
+        Transferer();
 
         MiniMC::CPA::State_ptr doTransfer(const MiniMC::CPA::State_ptr& s, const MiniMC::Model::Edge_ptr& e, proc_id id);
+
+      private:
+        std::shared_ptr<DecodeCache> decoded;
       };
 
       struct Joiner : public MiniMC::CPA::Joiner {
         MiniMC::CPA::State_ptr doJoin(const MiniMC::CPA::State_ptr& l, const MiniMC::CPA::State_ptr& r) { return nullptr; }
-        bool covers(const MiniMC::CPA::State_ptr& l, const MiniMC::CPA::State_ptr& r) {
-          return l->hash() == r->hash();
-        }
+
+        /** 
+         *  \p l covers \p r if they have the same variable values and heap
+         */
+        bool covers(const MiniMC::CPA::State_ptr& l, const MiniMC::CPA::State_ptr& r);
       };
 
       struct PrevalidateSetup : public MiniMC::CPA::PrevalidateSetup {
@@ -48,7 +63,7 @@ namespace MiniMC {
           StateQuery,
           Transferer,
           Joiner,
-          MiniMC::CPA::Storer,
+          MiniMC::CPA::HashStorer,
           MiniMC::CPA::PrevalidateSetup>;
 
       /*struct CPADef {
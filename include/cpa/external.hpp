@@ -0,0 +1,336 @@
+/**
+ * @file   external.hpp
+ *
+ * @brief  Storer and queue that keep most of the search on disk
+ *
+ * The storer only keeps a 64 bit fingerprint per State, like the
+ * approximate storers, so two States with the same fingerprint are
+ * taken to be equal. It is only sound to use for CPAs whose covering
+ * relation is equality. The queue keeps the serialized States of a
+ * layer of the breadth first search.
+ */
+#ifndef _CPA_EXTERNAL__
+#define _CPA_EXTERNAL__
+
+#include "cpa/interface.hpp"
+#include "support/exceptions.hpp"
+#include "support/serialize.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace MiniMC {
+  namespace CPA {
+
+    /**
+     * Passed set with delayed duplicate detection. New fingerprints
+     * are collected in an in-memory set of at most \p bytes. States
+     * are only compared against that set when they are saved; the
+     * comparison against the fingerprints on disk is delayed until
+     * flush, which merges the in-memory set into a sorted file on
+     * disk with one sequential pass over it.
+     *
+     * flush reports which of the States saved since the previous
+     * flush were already on disk. The search is responsible for
+     * dropping those States from its waiting list before they are
+     * explored.
+     */
+    class ExternalStorer : public IStorer {
+    public:
+      using Duplicates = std::unordered_map<const State*, MiniMC::Hash::hash_t>;
+
+      ExternalStorer(std::size_t bytes, const std::filesystem::path& dir) : capacity(std::max<std::size_t>(bytes / bytesPerEntry, 1)),
+                                                                             file(dir / ("minimc-" + std::to_string(::getpid()) + "-" + std::to_string(nextFile++) + ".fp")) {
+        std::ofstream create(file, std::ios::binary | std::ios::trunc);
+        if (!create)
+          throw MiniMC::Support::Exception("Cannot create scratch file " + file.string());
+      }
+
+      ~ExternalStorer() {
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+      }
+
+      State_ptr loadState(StorageTag) override {
+        throw MiniMC::Support::Exception("External storage cannot load states");
+      }
+
+      IStorer::JoinPair joinState(const State_ptr& state) override {
+        saveState(state);
+        return {.orig = nullptr, .joined = nullptr};
+      }
+
+      State_ptr isCoveredByStore(const State_ptr& state) override {
+        return hot.count(state->hash()) ? state : nullptr;
+      }
+
+      bool saveState(const State_ptr& state, StorageTag* tag = nullptr) override {
+        auto hash = state->hash();
+        if (tag)
+          *tag = hash;
+        if (hot.insert(hash).second)
+          unchecked[state.get()] = hash;
+        return true;
+      }
+
+      IStorer::Iterator stored_begin() override { return empty.begin(); }
+      IStorer::Iterator stored_end() override { return empty.end(); }
+
+      /**
+       * @return true if the in-memory set has reached its budget
+       */
+      bool full() const { return hot.size() >= capacity; }
+
+      /**
+       * @return number of fingerprints the in-memory set can hold
+       */
+      std::size_t getCapacity() const { return capacity; }
+
+      /**
+       * @return directory of the scratch files
+       */
+      std::filesystem::path directory() const { return file.parent_path(); }
+
+      /**
+       * Merge the in-memory fingerprints into the file on disk.
+       *
+       * @return the States saved since the last flush whose
+       * fingerprint was already on disk, with that fingerprint
+       */
+      Duplicates flush() {
+        std::vector<MiniMC::Hash::hash_t> fresh(hot.begin(), hot.end());
+        std::sort(fresh.begin(), fresh.end());
+        std::unordered_set<MiniMC::Hash::hash_t> seen;
+
+        auto merged = file;
+        merged += ".new";
+        {
+          std::ifstream in(file, std::ios::binary);
+          std::ofstream out(merged, std::ios::binary | std::ios::trunc);
+          Reader reader(in);
+          Writer writer(out);
+          for (auto fp : fresh) {
+            while (reader.valid() && reader.current() < fp) {
+              writer.write(reader.current());
+              reader.next();
+            }
+            if (reader.valid() && reader.current() == fp) {
+              seen.insert(fp);
+              reader.next();
+            }
+            writer.write(fp);
+          }
+          for (; reader.valid(); reader.next())
+            writer.write(reader.current());
+          writer.finish();
+          if (!out)
+            throw MiniMC::Support::Exception("Could not write scratch file " + merged.string());
+        }
+        std::filesystem::rename(merged, file);
+        onDisk += fresh.size() - seen.size();
+
+        Duplicates res;
+        for (auto& [state, hash] : unchecked) {
+          if (seen.count(hash))
+            res.emplace(state, hash);
+        }
+        hot.clear();
+        unchecked.clear();
+        flushes++;
+        return res;
+      }
+
+      /**
+       * @return number of distinct fingerprints stored on disk and in memory
+       */
+      std::size_t stored() const { return onDisk + hot.size(); }
+      std::size_t getFlushes() const { return flushes; }
+      std::size_t diskBytes() const { return onDisk * sizeof(MiniMC::Hash::hash_t); }
+
+      /**
+       * @return Estimate of the probability that at least two
+       * different States had the same fingerprint
+       */
+      double omissionProbability() const {
+        double n = stored();
+        return -std::expm1(-(n * n) / std::ldexp(1.0, 65));
+      }
+
+    private:
+      // Approximate memory of one entry in the in-memory set
+      static constexpr std::size_t bytesPerEntry = 48;
+      static constexpr std::size_t bufferEntries = 1 << 16;
+      static inline std::atomic<std::size_t> nextFile = 0;
+
+      class Reader {
+      public:
+        Reader(std::istream& is) : is(is), buffer(bufferEntries) { fill(); }
+        bool valid() const { return pos < size; }
+        MiniMC::Hash::hash_t current() const { return buffer[pos]; }
+        void next() {
+          if (++pos == size)
+            fill();
+        }
+
+      private:
+        void fill() {
+          pos = 0;
+          is.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(MiniMC::Hash::hash_t));
+          size = is.gcount() / sizeof(MiniMC::Hash::hash_t);
+        }
+
+        std::istream& is;
+        std::vector<MiniMC::Hash::hash_t> buffer;
+        std::size_t pos = 0;
+        std::size_t size = 0;
+      };
+
+      class Writer {
+      public:
+        Writer(std::ostream& os) : os(os) { buffer.reserve(bufferEntries); }
+        void write(MiniMC::Hash::hash_t fp) {
+          buffer.push_back(fp);
+          if (buffer.size() == bufferEntries)
+            finish();
+        }
+        void finish() {
+          os.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(MiniMC::Hash::hash_t));
+          buffer.clear();
+        }
+
+      private:
+        std::ostream& os;
+        std::vector<MiniMC::Hash::hash_t> buffer;
+      };
+
+      std::size_t capacity;
+      std::filesystem::path file;
+      std::unordered_set<MiniMC::Hash::hash_t> hot;
+      std::unordered_map<const State*, MiniMC::Hash::hash_t> unchecked;
+      std::size_t onDisk = 0;
+      std::size_t flushes = 0;
+      std::vector<State_ptr> empty;
+    };
+
+    /**
+     * FIFO queue of States kept serialized in a scratch file in \p
+     * dir. Pushed States are appended to a buffer that is written to
+     * the file once it holds \p bytes. pop reads the file back \p
+     * bytes at a time and turns each record into a State with \p
+     * load. All States must be pushed before the first pop.
+     */
+    class ExternalQueue {
+    public:
+      using Loader = std::function<State_ptr(MiniMC::Support::Reader&)>;
+
+      ExternalQueue(const std::filesystem::path& dir, Loader load, std::size_t bytes = 1 << 20) : load(std::move(load)),
+                                                                                                  bytes(std::max<std::size_t>(bytes, 1)),
+                                                                                                  file(dir / ("minimc-" + std::to_string(::getpid()) + "-" + std::to_string(nextFile++) + ".queue")),
+                                                                                                  out(file, std::ios::binary | std::ios::trunc) {
+        if (!out)
+          throw MiniMC::Support::Exception("Cannot create scratch file " + file.string());
+      }
+
+      ExternalQueue(const ExternalQueue&) = delete;
+      ExternalQueue& operator=(const ExternalQueue&) = delete;
+
+      ~ExternalQueue() {
+        out.close();
+        in.close();
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+      }
+
+      void push(const State_ptr& state) {
+        if (in.is_open())
+          throw MiniMC::Support::Exception("Push to an ExternalQueue after pop");
+        record.clear();
+        MiniMC::Support::Writer recWriter(record);
+        state->serialize(recWriter);
+        MiniMC::Support::Writer writer(buffer);
+        writer.varint(record.size());
+        writer.bytes(record.data(), record.size());
+        if (buffer.size() >= bytes)
+          write();
+        pushed++;
+      }
+
+      /**
+       * @return the oldest State in the queue, or nullptr if it is empty
+       */
+      State_ptr pop() {
+        if (!size())
+          return nullptr;
+        if (!in.is_open()) {
+          write();
+          out.close();
+          in.open(file, std::ios::binary);
+          if (!in)
+            throw MiniMC::Support::Exception("Cannot read scratch file " + file.string());
+        }
+        // A varint length takes at most 10 bytes
+        available(10);
+        MiniMC::Support::Reader lengthReader(buffer.data() + pos, buffer.size() - pos);
+        auto length = lengthReader.varint();
+        pos = buffer.size() - lengthReader.remaining();
+        available(length);
+        MiniMC::Support::Reader reader(buffer.data() + pos, length);
+        auto state = load(reader);
+        if (!reader.atEnd())
+          throw MiniMC::Support::SerializationError("Trailing bytes after serialized State");
+        pos += length;
+        popped++;
+        return state;
+      }
+
+      /**
+       * @return number of States pushed and not yet popped
+       */
+      std::size_t size() const { return pushed - popped; }
+
+    private:
+      static inline std::atomic<std::size_t> nextFile = 0;
+
+      void write() {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        if (!out)
+          throw MiniMC::Support::Exception("Could not write scratch file " + file.string());
+        buffer.clear();
+      }
+
+      // Make at least n bytes available after pos, unless the file ends first
+      void available(std::size_t n) {
+        if (buffer.size() - pos >= n)
+          return;
+        buffer.erase(buffer.begin(), buffer.begin() + pos);
+        pos = 0;
+        auto old = buffer.size();
+        buffer.resize(old + std::max(n, bytes));
+        in.read(reinterpret_cast<char*>(buffer.data() + old), buffer.size() - old);
+        buffer.resize(old + in.gcount());
+      }
+
+      Loader load;
+      std::size_t bytes;
+      std::filesystem::path file;
+      std::ofstream out;
+      std::ifstream in;
+      std::vector<MiniMC::uint8_t> buffer;
+      std::vector<MiniMC::uint8_t> record;
+      std::size_t pos = 0;
+      std::size_t pushed = 0;
+      std::size_t popped = 0;
+    };
+
+  } // namespace CPA
+} // namespace MiniMC
+
+#endif
@@ -45,10 +45,50 @@ namespace MiniMC {
        * @return number of processes
        */
       virtual size_t nbOfProcesses(const State_ptr&) { return 0; }
+
+      /**
+       * Read back a State written by State::serialize
+       *
+       * @return the State
+       */
+      virtual State_ptr deserialize(MiniMC::Support::Reader&, const MiniMC::Model::Program&) {
+        throw MiniMC::Support::SerializationError("CPA does not support deserialization");
+      }
     };
 
     using StateQuery_ptr = std::shared_ptr<StateQuery>;
 
+    /**
+     * Version of the serialized State format. Bump it whenever the
+     * format of any CPA changes.
+     */
+    constexpr MiniMC::uint8_t serializationVersion = 1;
+
+    /**
+     * @return \p state serialized with a leading format version
+     */
+    inline std::vector<MiniMC::uint8_t> serializeState(const State& state) {
+      std::vector<MiniMC::uint8_t> res;
+      MiniMC::Support::Writer writer(res);
+      writer.byte(serializationVersion);
+      state.serialize(writer);
+      return res;
+    }
+
+    /**
+     * Read back a State written by serializeState
+     */
+    inline State_ptr deserializeState(StateQuery& query, const MiniMC::Model::Program& prgm, const MiniMC::uint8_t* data, std::size_t size) {
+      MiniMC::Support::Reader reader(data, size);
+      auto version = reader.byte();
+      if (version != serializationVersion)
+        throw MiniMC::Support::SerializationError("Unsupported serialization version " + std::to_string(version));
+      auto res = query.deserialize(reader, prgm);
+      if (!reader.atEnd())
+        throw MiniMC::Support::SerializationError("Trailing bytes after serialized State");
+      return res;
+    }
+
     /** 
      * The Tranferer generates successor for States
      */
@@ -118,6 +158,12 @@ namespace MiniMC {
 
     using Storer_ptr = std::shared_ptr<IStorer>;
 
+    /** 
+     * Storer that compares a State to all stored States. Needed for
+     * CPAs with a genuine subsumption relation or join operation.
+     * CPAs for which covering is plain equality should use
+     * HashStorer instead.
+     */
     class Storer : public IStorer {
     public:
       Storer(const Joiner_ptr& join) : JoinOperation(join) {}
@@ -191,6 +237,69 @@ namespace MiniMC {
       Joiner_ptr JoinOperation;
     };
 
+    /** 
+     * Storer for CPAs whose covering relation is plain equality of
+     * states. States are indexed by their hash value, such that a
+     * lookup only has to consult the Joiner for the (few) stored
+     * States with the same hash value as the queried State. 
+     */
+    class HashStorer : public IStorer {
+    public:
+      HashStorer(const Joiner_ptr& join) : JoinOperation(join) {}
+      virtual ~HashStorer() {}
+
+      bool saveState(const State_ptr& state, StorageTag* tag = nullptr) {
+        assert(!isCoveredByStore(state));
+        if (tag)
+          *tag = actualStore.size();
+        index.emplace(state->hash(), actualStore.size());
+        actualStore.emplace_back(state);
+        return true;
+      }
+
+      State_ptr loadState(StorageTag st) {
+        return actualStore.at(st);
+      }
+
+      IStorer::JoinPair joinState(const State_ptr& state) {
+        auto hash = state->hash();
+        auto range = index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+          auto& stored = actualStore[it->second];
+          auto res = JoinOperation->doJoin(stored, state);
+          if (res) {
+            auto orig = stored;
+            auto pos = it->second;
+            stored = res;
+            index.erase(it);
+            index.emplace(res->hash(), pos);
+            return {.orig = orig, .joined = res};
+          }
+        }
+        saveState(state);
+        return {.orig = nullptr, .joined = nullptr};
+      }
+
+      State_ptr isCoveredByStore(const State_ptr& state) {
+        auto range = index.equal_range(state->hash());
+        for (auto it = range.first; it != range.second; ++it) {
+          auto& stored = actualStore[it->second];
+          if (JoinOperation->covers(stored, state)) {
+            return stored;
+          }
+        }
+        return nullptr;
+      }
+
+      IStorer::Iterator stored_begin() { return actualStore.begin(); }
+      IStorer::Iterator stored_end() { return actualStore.end(); }
+
+    private:
+      std::vector<State_ptr> actualStore;
+      std::unordered_multimap<MiniMC::Hash::hash_t, std::size_t> index;
+      Joiner_ptr JoinOperation;
+    };
+
     struct ICPA {
       virtual ~ICPA() {}
       virtual StateQuery_ptr makeQuery() const = 0;
@@ -209,6 +318,12 @@ namespace MiniMC {
         class Store,
         class Prevalidate>
     struct CPADef : public ICPA {
+      using QueryType = Query;
+      using TransferType = Transfer;
+      using JoinType = Joiner;
+      using StoreType = Store;
+      using PrevalidateType = Prevalidate;
+
       virtual StateQuery_ptr makeQuery() const { return std::make_shared<Query>(); }
       virtual Transferer_ptr makeTransfer() const { return std::make_shared<Transfer>(); }
       virtual Joiner_ptr makeJoin() const { return std::make_shared<Joiner>(); }
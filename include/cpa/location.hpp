@@ -19,6 +19,7 @@ namespace MiniMC {
         State_ptr makeInitialState(const MiniMC::Model::Program&);
         size_t nbOfProcesses(const State_ptr&) override;
         MiniMC::Model::Location_ptr getLocation(const State_ptr&, proc_id);
+        State_ptr deserialize(MiniMC::Support::Reader&, const MiniMC::Model::Program&) override;
       };
 
       struct Transferer : public MiniMC::CPA::Transferer {
@@ -27,29 +28,27 @@ namespace MiniMC {
 
       struct Joiner : public MiniMC::CPA::Joiner {
         /** 
-	 * The Location tracking CPA can only join if the two states has equal hash value.  
+	 * The Location tracking CPA can only join if the two states are equal.  
 	 *
 	 * @return 
 	 */
         State_ptr doJoin(const State_ptr& l, const State_ptr& r) override {
-          if (std::hash<MiniMC::CPA::State>{}(*l) == std::hash<MiniMC::CPA::State>{}(*r))
+          if (covers(l, r))
             return l;
           return nullptr;
         }
 
         /** 
-		 *  \p l covers \p r if their hash values are the same 
+		 *  \p l covers \p r if all processes are at the same locations 
 		 */
-        bool covers(const State_ptr& l, const State_ptr& r) override {
-          return std::hash<MiniMC::CPA::State>{}(*l) == std::hash<MiniMC::CPA::State>{}(*r);
-        }
+        bool covers(const State_ptr& l, const State_ptr& r) override;
       };
 
       using CPA = CPADef<
           StateQuery,
           Transferer,
           Joiner,
-          MiniMC::CPA::Storer,
+          MiniMC::CPA::HashStorer,
           MiniMC::CPA::PrevalidateSetup>;
 
     } // namespace Location
@@ -74,11 +73,9 @@ namespace MiniMC {
         State_ptr doJoin(const State_ptr& l, const State_ptr& r);
 
         /** 
-	 *  \p l covers \p r if their hash values are the same 
+	 *  \p l covers \p r if they are at the same location 
 	 */
-        bool covers(const State_ptr& l, const State_ptr& r) {
-          return std::hash<MiniMC::CPA::State>{}(*l) == std::hash<MiniMC::CPA::State>{}(*r);
-        }
+        bool covers(const State_ptr& l, const State_ptr& r);
       };
 
       using CPA = CPADef<
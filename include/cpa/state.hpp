@@ -15,9 +15,12 @@
 #include "model/variables.hpp"
 #include "support/exceptions.hpp"
 #include "support/localisation.hpp"
+#include "support/serialize.hpp"
 #include "util/array.hpp"
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 namespace MiniMC {
   namespace CPA {
@@ -49,6 +52,14 @@ namespace MiniMC {
 
     using Concretizer_ptr = std::shared_ptr<Concretizer>;
 
+    class Interner;
+
+    /**
+     * Maps a Location of process \p from to the corresponding Location
+     * of the symmetric process \p to
+     */
+    using Relocation = std::function<MiniMC::Model::Location*(MiniMC::Model::Location* loc, proc_id from, proc_id to)>;
+
     /** A general CPA state interface. It is deliberately kept minimal to relay no information to observers besides what is absolutely needed 
      * 
      */
@@ -87,6 +98,36 @@ namespace MiniMC {
       virtual bool ready2explore() const { return true; }
 
       virtual const Concretizer_ptr getConcretizer() const { return std::make_shared<Concretizer>(); }
+
+      /**
+       * Write a compact binary representation of this State. It can
+       * be read back by the deserialize function of the StateQuery of
+       * the CPA that created the State.
+       */
+      virtual void serialize(MiniMC::Support::Writer&) const {
+        throw MiniMC::Support::SerializationError("State does not support serialization");
+      }
+
+      /**
+       * Replace the components of this State by equal instances from
+       * \p interner (see CollapseStorer). Must not change the value
+       * or hash of the State.
+       */
+      virtual void intern(Interner&) {}
+
+      /**
+       * Hash of the part of this State that belongs to process \p id,
+       * as if it were process \p as. Used to order symmetric processes.
+       */
+      virtual MiniMC::Hash::hash_t processHash(proc_id id, proc_id as, const Relocation&) const { return 0; }
+
+      /**
+       * @return copy of this State in which process i is process
+       * perm[i] of this State
+       */
+      virtual std::shared_ptr<State> permute(const std::vector<proc_id>& perm, const Relocation&) const {
+        throw MiniMC::Support::Exception("State does not support symmetry reduction");
+      }
     };
 
     using State_ptr = std::shared_ptr<State>;
@@ -0,0 +1,192 @@
+/**
+ * @file   benchruns.hpp
+ *
+ * @brief  Measurements of the runs of the bench command
+ *
+ * Runs are written as CSV or JSON. A CSV of earlier runs serves as
+ * baseline that new runs are compared against.
+ */
+#ifndef _BENCHRUNS__
+#define _BENCHRUNS__
+
+#include "support/feedback.hpp"
+#include "support/localisation.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace MiniMC {
+  namespace Support {
+    namespace Bench {
+
+      /**
+       * Measurements of running one configuration once
+       */
+      struct Run {
+        std::string config;
+        std::string variant;
+        std::size_t run = 0;
+        std::string result; /**< Verification result, or how the run ended if it has none */
+        std::size_t states = 0;
+        double wall = 0;
+        std::size_t peakRSS = 0; // KB
+      };
+
+      inline std::string key(const std::string& config, const std::string& variant) {
+        return variant.size() ? config + " [" + variant + "]" : config;
+      }
+
+      /**
+       * @return the text following \p field in \p json, the statistics
+       * written by the mc and enum commands, or the empty string if
+       * the field is missing
+       */
+      inline std::string readField(const std::string& json, const std::string& field) {
+        auto pattern = "\"" + field + "\":";
+        auto pos = json.find(pattern);
+        if (pos == std::string::npos)
+          return "";
+        pos += pattern.size();
+        return json.substr(pos, json.find('\n', pos) - pos);
+      }
+
+      /**
+       * @return the number in \p field, or 0 if it is missing
+       */
+      inline std::size_t readStatistic(const std::string& json, const std::string& field) {
+        auto value = readField(json, field);
+        return value.size() ? std::stoull(value) : 0;
+      }
+
+      /**
+       * @return the string in \p field, or the empty string if it is missing
+       */
+      inline std::string readString(const std::string& json, const std::string& field) {
+        std::stringstream value(readField(json, field));
+        std::string res;
+        value >> std::quoted(res);
+        return res;
+      }
+
+      inline std::string quote(const std::string& str) {
+        std::stringstream res;
+        res << std::quoted(str);
+        return res.str();
+      }
+
+      inline void writeCSV(std::ostream& os, const std::vector<Run>& runs) {
+        os << "config,variant,run,result,states,wall_s,peak_rss_kb\n";
+        for (auto& r : runs)
+          os << quote(r.config) << "," << quote(r.variant) << "," << r.run << "," << r.result << "," << r.states << "," << std::fixed << std::setprecision(4) << r.wall << "," << r.peakRSS << "\n";
+      }
+
+      inline void writeJSON(std::ostream& os, const std::vector<Run>& runs) {
+        os << "[\n";
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+          auto& r = runs[i];
+          os << "  {\"config\": " << quote(r.config)
+             << ", \"variant\": " << quote(r.variant)
+             << ", \"run\": " << r.run
+             << ", \"result\": " << quote(r.result)
+             << ", \"states\": " << r.states
+             << ", \"wall_s\": " << std::fixed << std::setprecision(4) << r.wall
+             << ", \"peak_rss_kb\": " << r.peakRSS << "}"
+             << (i + 1 < runs.size() ? ",\n" : "\n");
+        }
+        os << "]\n";
+      }
+
+      /**
+       * Read runs written by writeCSV. Lines that do not parse are skipped.
+       */
+      inline std::vector<Run> readCSV(std::istream& is) {
+        std::vector<Run> res;
+        std::string line;
+        std::getline(is, line);
+        while (std::getline(is, line)) {
+          std::stringstream str(line);
+          Run r;
+          char sep;
+          str >> std::quoted(r.config) >> sep >> std::quoted(r.variant) >> sep >> r.run >> sep;
+          std::getline(str, r.result, ',');
+          str >> r.states >> sep >> r.wall >> sep >> r.peakRSS;
+          if (str)
+            res.push_back(r);
+        }
+        return res;
+      }
+
+      /**
+       * The runs of one configuration summarised by the median wall time
+       * and the largest peak memory
+       */
+      struct Summary {
+        std::string result;
+        std::size_t states = 0;
+        double wall = 0;
+        std::size_t peakRSS = 0;
+      };
+
+      inline std::map<std::string, Summary> summarise(const std::vector<Run>& runs) {
+        std::map<std::string, std::vector<const Run*>> grouped;
+        for (auto& r : runs)
+          grouped[key(r.config, r.variant)].push_back(&r);
+        std::map<std::string, Summary> res;
+        for (auto& [k, group] : grouped) {
+          std::vector<double> walls;
+          Summary sum{.result = group[0]->result, .states = group[0]->states};
+          for (auto r : group) {
+            walls.push_back(r->wall);
+            sum.peakRSS = std::max(sum.peakRSS, r->peakRSS);
+          }
+          std::sort(walls.begin(), walls.end());
+          sum.wall = walls[walls.size() / 2];
+          res[k] = sum;
+        }
+        return res;
+      }
+
+      /**
+       * Report the configurations whose result changed or whose median
+       * wall time or peak memory grew by more than the threshold
+       * @return the number of regressions
+       */
+      inline std::size_t compare(const std::vector<Run>& runs, const std::vector<Run>& baseline, double threshold, MiniMC::Support::Messager& mess) {
+        auto current = summarise(runs);
+        auto base = summarise(baseline);
+        std::size_t regressions = 0;
+        for (auto& [k, cur] : current) {
+          auto it = base.find(k);
+          if (it == base.end()) {
+            mess.message(MiniMC::Support::Localiser("%1%: not in the baseline").format(k));
+            continue;
+          }
+          auto& old = it->second;
+          if (cur.result != old.result) {
+            mess.warning(MiniMC::Support::Localiser("%1%: result %2% (baseline %3%)").format(k, cur.result, old.result));
+            regressions++;
+          }
+          if (cur.states != old.states)
+            mess.warning(MiniMC::Support::Localiser("%1%: %2% states explored (baseline %3%)").format(k, cur.states, old.states));
+          if (cur.wall > old.wall * (1 + threshold)) {
+            mess.warning(MiniMC::Support::Localiser("%1%: wall time %2%s (baseline %3%s)").format(k, cur.wall, old.wall));
+            regressions++;
+          }
+          if (cur.peakRSS > old.peakRSS * (1 + threshold)) {
+            mess.warning(MiniMC::Support::Localiser("%1%: peak memory %2% KB (baseline %3% KB)").format(k, cur.peakRSS, old.peakRSS));
+            regressions++;
+          }
+        }
+        return regressions;
+      }
+
+    } // namespace Bench
+  } // namespace Support
+} // namespace MiniMC
+
+#endif
@@ -10,8 +10,12 @@
 #ifndef _RANDOM__
 #define _RANDOM__
 
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <random>
 #include <type_traits>
 #include <vector>
@@ -21,10 +25,70 @@
 namespace MiniMC {
   namespace Support {
 
+    /**
+     * SplitMix64 generator. Its state is a single 64 bit counter, so
+     * independent streams can be derived cheaply from a seed and a
+     * stream index.
+     */
+    class SplitMix64 {
+    public:
+      using result_type = std::uint64_t;
+
+      SplitMix64(result_type seed = 0) : state(seed) {}
+
+      /**
+       * Stream number \p stream derived from \p seed
+       */
+      SplitMix64(result_type seed, result_type stream) : state(mix(seed + mix(stream + gamma))) {}
+
+      static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+      static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+      result_type operator()() { return mix(state += gamma); }
+
+      void seed(result_type s) { state = s; }
+
+    private:
+      static constexpr result_type gamma = 0x9e3779b97f4a7c15ull;
+
+      static constexpr result_type mix(result_type z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+      }
+
+      result_type state;
+    };
+
+    namespace Detail {
+      inline std::optional<std::uint64_t>& seedValue() {
+        static std::optional<std::uint64_t> seed;
+        return seed;
+      }
+    } // namespace Detail
+
+    /**
+     * Set the seed all random streams are derived from. Must be
+     * called before any random numbers are drawn.
+     */
+    inline void setSeed(std::uint64_t seed) {
+      Detail::seedValue() = seed;
+    }
+
+    /**
+     * @return the seed set by setSeed, or one drawn from
+     * std::random_device the first time it is needed
+     */
+    inline std::uint64_t getSeed() {
+      static std::uint64_t drawn = (static_cast<std::uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+      return Detail::seedValue().value_or(drawn);
+    }
+
     /** RandomNumber generator "wrapper" with  a thread_local \p Engine for generating numbers.
+	 * Each thread starts on its own stream derived from getSeed().
 	 * \tparam Engine The random number generator. 
 	 */
-    template <class Engine = std::mt19937_64>
+    template <class Engine = SplitMix64>
     class RandomNumber {
     public:
       template <typename T, std::enable_if_t<std::is_integral<T>::value, bool> = 0>
@@ -44,7 +108,7 @@ namespace MiniMC {
 
       template <typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> = 0>
       T uniform(T min, T max) {
-        return std::uniform_real_distribution<T>{min, max}(getEngine);
+        return std::uniform_real_distribution<T>{min, max}(getEngine());
       }
 
       template <typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> = 0>
@@ -63,9 +127,18 @@ namespace MiniMC {
         return c.at(this->uniform<std::size_t>(0, c.size() - 1));
       }
 
+      /**
+       * Switch the calling thread to stream \p stream of getSeed().
+       * The numbers drawn afterwards only depend on the seed and \p stream.
+       */
+      static void selectStream(std::uint64_t stream) {
+        getEngine() = Engine(getSeed(), stream);
+      }
+
     private:
-      auto& getEngine() {
-        static thread_local Engine engine(std::random_device{}());
+      static auto& getEngine() {
+        static std::atomic<std::uint64_t> threads = 0;
+        static thread_local Engine engine(getSeed(), threads++);
         return engine;
       }
     };
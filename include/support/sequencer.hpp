@@ -1,7 +1,11 @@
 #ifndef _SEQUENCER__
 #define _SEQUENCER__
 
+#include "support/timing.hpp"
+#include <boost/core/demangle.hpp>
 #include <memory>
+#include <string>
+#include <typeinfo>
 #include <vector>
 
 namespace MiniMC {
@@ -11,18 +15,36 @@ namespace MiniMC {
       virtual bool run(T&) { return true; };
     };
 
+    /**
+     * @return the name of \p P without namespaces and template arguments
+     */
+    template <class P>
+    std::string sinkName() {
+      auto name = boost::core::demangle(typeid(P).name());
+      name = name.substr(0, name.find('<'));
+      auto pos = name.rfind("::");
+      return pos == std::string::npos ? name : name.substr(pos + 2);
+    }
+
+    /**
+     * Runs a sequence of Sinks. Each Sink runs as a profiled Phase
+     * named after its type, nested in the Phase "Setup".
+     */
     template <class T>
     class Sequencer {
     public:
       template <class P, class... Args>
       Sequencer<T>& add(Args... args) {
         sinks.push_back(std::make_unique<P>(args...));
+        names.push_back(sinkName<P>());
         return *this;
       }
 
       bool run(T& t) {
-        for (auto& s : sinks) {
-          if (!s->run(t)) {
+        Phase setup("Setup");
+        for (std::size_t i = 0; i < sinks.size(); ++i) {
+          Phase phase(names[i]);
+          if (!sinks[i]->run(t)) {
             return false;
           }
         }
@@ -31,6 +53,7 @@ namespace MiniMC {
 
     private:
       std::vector<std::unique_ptr<Sink<T>>> sinks;
+      std::vector<std::string> names;
     };
 
     template <class T, class W, class... Args>
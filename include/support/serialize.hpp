@@ -0,0 +1,102 @@
+/**
+ * @file   serialize.hpp
+ *
+ * @brief  Byte buffers for the binary representation of States
+ *
+ * Integers are written as LEB128 varints, so small values (sizes,
+ * ids) take a single byte.
+ */
+#ifndef _SERIALIZE__
+#define _SERIALIZE__
+
+#include "support/exceptions.hpp"
+#include "support/types.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MiniMC {
+  namespace Support {
+
+    class SerializationError : public Exception {
+    public:
+      SerializationError(const std::string& mess) : Exception(mess) {}
+    };
+
+    /**
+     * Appends to a byte vector
+     */
+    class Writer {
+    public:
+      Writer(std::vector<MiniMC::uint8_t>& buffer) : buffer(buffer) {}
+
+      void varint(MiniMC::uint64_t val) {
+        while (val >= 0x80) {
+          buffer.push_back(static_cast<MiniMC::uint8_t>(val) | 0x80);
+          val >>= 7;
+        }
+        buffer.push_back(static_cast<MiniMC::uint8_t>(val));
+      }
+
+      void byte(MiniMC::uint8_t b) { buffer.push_back(b); }
+
+      void bytes(const MiniMC::uint8_t* data, std::size_t size) {
+        buffer.insert(buffer.end(), data, data + size);
+      }
+
+    private:
+      std::vector<MiniMC::uint8_t>& buffer;
+    };
+
+    /**
+     * Reads from a byte range written by a Writer. Reading past the
+     * end throws a SerializationError.
+     */
+    class Reader {
+    public:
+      Reader(const MiniMC::uint8_t* data, std::size_t size) : cur(data), end(data + size) {}
+      Reader(const std::vector<MiniMC::uint8_t>& buffer) : Reader(buffer.data(), buffer.size()) {}
+
+      MiniMC::uint64_t varint() {
+        MiniMC::uint64_t res = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+          auto b = byte();
+          res |= static_cast<MiniMC::uint64_t>(b & 0x7f) << shift;
+          if (!(b & 0x80))
+            return res;
+        }
+        throw SerializationError("Malformed varint");
+      }
+
+      MiniMC::uint8_t byte() {
+        need(1);
+        return *cur++;
+      }
+
+      /**
+       * @return pointer to the next \p size bytes, which stay valid as
+       * long as the underlying buffer does
+       */
+      const MiniMC::uint8_t* bytes(std::size_t size) {
+        need(size);
+        auto res = cur;
+        cur += size;
+        return res;
+      }
+
+      bool atEnd() const { return cur == end; }
+      std::size_t remaining() const { return end - cur; }
+
+    private:
+      void need(std::size_t size) const {
+        if (static_cast<std::size_t>(end - cur) < size)
+          throw SerializationError("Unexpected end of serialized data");
+      }
+
+      const MiniMC::uint8_t* cur;
+      const MiniMC::uint8_t* end;
+    };
+
+  } // namespace Support
+} // namespace MiniMC
+
+#endif
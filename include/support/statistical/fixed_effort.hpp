@@ -83,6 +83,12 @@ namespace MiniMC {
           total++;
         }
 
+        /** 
+		 *
+		 * @return  number of samples taken
+		 */
+        std::size_t samples() const { return total; }
+
       private:
         const std::size_t effort;
         std::size_t total = 0;
@@ -149,6 +155,12 @@ namespace MiniMC {
           update();
         }
 
+        /** 
+		 *
+		 * @return  number of samples taken
+		 */
+        std::size_t samples() const { return total; }
+
       private:
         void update() {
           lower = binomial_distribution<MiniMC::proba_t>::find_lower_bound_on_p(total, satis, satis < total ? alpha / 2 : alpha, binomial_distribution<MiniMC::proba_t>::clopper_pearson_exact_interval);
@@ -3,73 +3,117 @@
 
 #include "hash/hashing.hpp"
 #include "support/binary_encode.hpp"
+#include <algorithm>
+#include <cassert>
 #include <memory>
 #include <ostream>
 
 namespace MiniMC {
   namespace Util {
+    /**
+     * Byte buffer holding a value of the VM. Values of up to
+     * InlineSize bytes (all integers and pointers) are stored inside
+     * the Array itself, so only larger aggregates use the allocator.
+     */
     class Array {
     public:
-      Array() : buffer(nullptr), size(0) {
+      static constexpr std::size_t InlineSize = 16;
+
+      Array() : size(0) {
       }
-      Array(size_t s) : buffer(new MiniMC::uint8_t[s]), size(s) {
-        std::fill(buffer.get(), buffer.get() + size, 0);
+      Array(size_t s) : buffer(s > InlineSize ? new MiniMC::uint8_t[s] : nullptr), size(s) {
+        std::fill(data(), data() + size, 0);
       }
 
-      Array(const Array& a) {
+      Array(const Array& a) : size(0) {
         *this = a;
       }
 
+      Array(Array&& a) noexcept : buffer(std::move(a.buffer)), size(a.size) {
+        if (!buffer)
+          std::copy(a.inl, a.inl + size, inl);
+        a.size = 0;
+      }
+
       Array& operator=(const Array& a) {
         //assert(getSize() == a.getSize ());
-        buffer.reset(new MiniMC::uint8_t[a.size]);
+        if (this == &a)
+          return *this;
+        if (a.size > InlineSize) {
+          if (a.size != size || !buffer)
+            buffer.reset(new MiniMC::uint8_t[a.size]);
+        } else {
+          buffer.reset();
+        }
+        size = a.size;
+        std::copy(a.data(), a.data() + a.size, data());
+        return *this;
+      }
+
+      Array& operator=(Array&& a) noexcept {
+        if (this == &a)
+          return *this;
+        buffer = std::move(a.buffer);
         size = a.size;
-        std::copy(a.buffer.get(), a.buffer.get() + a.size, buffer.get());
+        if (!buffer)
+          std::copy(a.inl, a.inl + size, inl);
+        a.size = 0;
         return *this;
       }
 
       template <class T>
       T read(std::size_t byte = 0) const {
-        assert(buffer);
         assert(byte + sizeof(T) <= size);
         T var;
-        std::copy(buffer.get() + byte, buffer.get() + byte + sizeof(T), reinterpret_cast<MiniMC::uint8_t*>(&var));
+        std::copy(data() + byte, data() + byte + sizeof(T), reinterpret_cast<MiniMC::uint8_t*>(&var));
         return var;
       }
 
       template <class T>
       void set(std::size_t byte, const T& t) {
         assert(byte + sizeof(T) <= size);
-        std::copy(reinterpret_cast<const MiniMC::uint8_t*>(&t), reinterpret_cast<const MiniMC::uint8_t*>(&t) + sizeof(T), buffer.get() + byte);
+        std::copy(reinterpret_cast<const MiniMC::uint8_t*>(&t), reinterpret_cast<const MiniMC::uint8_t*>(&t) + sizeof(T), data() + byte);
       }
 
       void set_block(std::size_t byte, std::size_t block_size, const MiniMC::uint8_t* block) {
         assert(byte + block_size <= size);
-        std::copy(block, block + block_size, buffer.get() + byte);
+        std::copy(block, block + block_size, data() + byte);
       }
 
       void get_block(std::size_t byte, std::size_t block_size, MiniMC::uint8_t* block) {
         assert(byte + block_size <= size);
-        std::copy(buffer.get() + byte, buffer.get() + byte + block_size, block);
+        std::copy(data() + byte, data() + byte + block_size, block);
       }
 
       const MiniMC::uint8_t* get_direct_access() const {
-        return buffer.get();
+        return data();
       }
 
       std::size_t getSize() const { return size; }
 
       std::ostream& output(std::ostream& os) const {
         MiniMC::Support::Base64Encode encoder;
-        return os << encoder.encode(reinterpret_cast<const char*>(buffer.get()), size);
+        return os << encoder.encode(reinterpret_cast<const char*>(data()), size);
       }
 
       MiniMC::Hash::hash_t hash(MiniMC::Hash::seed_t s) const {
-        return MiniMC::Hash::Hash(buffer.get(), size, s);
+        return MiniMC::Hash::Hash(data(), size, s);
+      }
+
+      bool operator==(const Array& oth) const {
+        return size == oth.size && std::equal(data(), data() + size, oth.data());
+      }
+
+      bool operator!=(const Array& oth) const {
+        return !(*this == oth);
       }
 
     private:
+      MiniMC::uint8_t* data() { return buffer ? buffer.get() : inl; }
+      const MiniMC::uint8_t* data() const { return buffer ? buffer.get() : inl; }
+
       std::unique_ptr<MiniMC::uint8_t[]> buffer;
+      alignas(8) MiniMC::uint8_t inl[InlineSize];
       std::size_t size;
     };
 
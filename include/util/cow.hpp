@@ -0,0 +1,52 @@
+#ifndef _UTIL_COW__
+#define _UTIL_COW__
+
+#include <memory>
+
+namespace MiniMC {
+  namespace Util {
+    /**
+     * Copy-on-write handle to a T. Copying the handle only shares the
+     * underlying object; it is cloned the first time it is modified
+     * through a handle that is not the sole owner.
+     */
+    template <class T>
+    class CopyOnWrite {
+    public:
+      CopyOnWrite(const T& t) : ptr(std::make_shared<T>(t)) {}
+
+      const T& get() const { return *ptr; }
+
+      /**
+       * @return a reference to an object owned by this handle only
+       */
+      T& modify() {
+        if (ptr.use_count() > 1)
+          ptr = std::make_shared<T>(*ptr);
+        return *ptr;
+      }
+
+      bool shares(const CopyOnWrite& oth) const { return ptr == oth.ptr; }
+
+      const std::shared_ptr<T>& shared() const { return ptr; }
+
+      /**
+       * Share \p obj instead of the current object. \p obj must be
+       * equal to the current object.
+       */
+      void share(const std::shared_ptr<T>& obj) { ptr = obj; }
+
+      bool operator==(const CopyOnWrite& oth) const {
+        return shares(oth) || *ptr == *oth.ptr;
+      }
+
+      bool operator!=(const CopyOnWrite& oth) const { return !(*this == oth); }
+
+    private:
+      std::shared_ptr<T> ptr;
+    };
+
+  } // namespace Util
+} // namespace MiniMC
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef _VALUEMAP__
 #define _VALUEMAP__
 
+#include <algorithm>
 #include <functional>
 #include <gsl/pointers>
 #include <memory>
@@ -37,6 +38,17 @@ namespace MiniMC {
         return mem.get()[Index{}(f)];
       }
 
+      std::size_t getSize() const { return size; }
+
+      const T& atIndex(std::size_t i) const {
+        assert(i < size);
+        return mem.get()[i];
+      }
+      T& atIndex(std::size_t i) {
+        assert(i < size);
+        return mem.get()[i];
+      }
+
       std::ostream& output(std::ostream& os) const {
         for (size_t i = 0; i < size; i++) {
           os << i << " : " << mem[i] << "-" << mem[i].getSize() << std::endl;
@@ -52,6 +64,10 @@ namespace MiniMC {
         return seed;
       }
 
+      bool operator==(const FixedVector& oth) const {
+        return size == oth.size && std::equal(mem.get(), mem.get() + size, oth.mem.get());
+      }
+
     private:
       std::unique_ptr<T[]> mem;
       std::size_t size;
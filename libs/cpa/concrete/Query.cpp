@@ -1,3 +1,4 @@
+#include <atomic>
 #include <gsl/pointers>
 #include <memory>
 
@@ -12,92 +13,176 @@ namespace MiniMC {
     namespace Concrete {
       class MConcretizer : public MiniMC::CPA::Concretizer {
       public:
-        MConcretizer(const VariableLookup& globals, const std::vector<VariableLookup>& v) : globals(globals), vars(v) {}
+        MConcretizer(const SharedVariableLookup& globals, const std::vector<SharedVariableLookup>& v) : globals(globals), vars(v) {}
         virtual MiniMC::CPA::Concretizer::Feasibility isFeasible() const override { return Feasibility::Feasible; }
 
         virtual std::ostream& evaluate_str(proc_id id, const MiniMC::Model::Variable_ptr& var, std::ostream& os) {
           if (var->isGlobal()) {
-            return os << globals.at(var);
+            return os << globals.get().at(var);
           } else {
-            return os << vars.at(id).at(var);
+            return os << vars.at(id).get().at(var);
           }
         }
 
         virtual MiniMC::Util::Array evaluate(proc_id id, const MiniMC::Model::Variable_ptr& var) override {
           if (var->isGlobal()) {
-            return globals.at(var);
+            return globals.get().at(var);
           } else {
-            return vars.at(id).at(var);
+            return vars.at(id).get().at(var);
           }
         }
 
       private:
-        const VariableLookup& globals;
-        const std::vector<VariableLookup>& vars;
+        const SharedVariableLookup& globals;
+        const std::vector<SharedVariableLookup>& vars;
       };
 
+      /**
+       * The globals, each process' variables and the heap are shared
+       * between a State and its copies until one of them writes to
+       * them.
+       */
       class State : public MiniMC::CPA::State, public MiniMC::CPA::Concretizer {
       public:
-        State(const VariableLookup& g, const std::vector<VariableLookup>& var) : globals(g), proc_vars(var) {
+        State(const VariableLookup& g, const std::vector<VariableLookup>& var) : globals(g), proc_vars(var.begin(), var.end()), heap(Heap{}) {
         }
+        State(const State& oth) : globals(oth.globals),
+                                  proc_vars(oth.proc_vars),
+                                  heap(oth.heap),
+                                  hash_val(oth.hash_val.load(std::memory_order_relaxed)) {}
         virtual std::ostream& output(std::ostream& os) const {
           os << "Globals\n";
-          os << globals << "\n";
+          os << globals.get() << "\n";
           for (auto& vl : proc_vars) {
             os << "===\n";
-            os << vl << "\n";
+            os << vl.get() << "\n";
           }
           return os << "==\n";
         }
 
+        /**
+         * The variable frames and the heap maintain their own digests
+         * while being written, so computing the hash only combines one
+         * value per component. The result is buffered until the
+         * State is accessed through one of its non-const accessors.
+         */
         virtual MiniMC::Hash::hash_t hash(MiniMC::Hash::seed_t seed = 0) const override {
-          if (!hash_val) {
-            MiniMC::Hash::hash_combine(seed, globals);
+          auto buffered = hash_val.load(std::memory_order_relaxed);
+          if (seed || !buffered) {
+            auto start = seed;
+            MiniMC::Hash::hash_combine(seed, globals.get());
             for (auto& vl : proc_vars) {
-              MiniMC::Hash::hash_combine(seed, vl);
+              MiniMC::Hash::hash_combine(seed, vl.get());
             }
-            MiniMC::Hash::hash_combine(seed, heap);
-            //uncommnented the update of this buffered hash value. It
-            //disables the buffering as it might be incorrect
-            //The State is really just a container and the parts
-            //making up its hash-values can actually change outside
-            //its knowledge....making it impossible to keep
-            //precomputed hash_value up to date
-            //hash_val = seed;
+            MiniMC::Hash::hash_combine(seed, heap.get());
+            if (!start)
+              hash_val.store(seed, std::memory_order_relaxed);
             return seed;
           }
-          return hash_val;
+          return buffered;
         }
 
         virtual std::shared_ptr<MiniMC::CPA::State> copy() const {
           return std::make_shared<State>(*this);
         }
 
-        auto& getGlobals() { return globals; }
-        auto& getProc(std::size_t i) { return proc_vars[i]; }
-        auto& getHeap() { return heap; }
+        auto& getGlobals() {
+          hash_val = 0;
+          return globals;
+        }
+        auto& getProc(std::size_t i) {
+          hash_val = 0;
+          return proc_vars[i];
+        }
+        auto& getHeap() {
+          hash_val = 0;
+          return heap;
+        }
 
         auto& getGlobals() const { return globals; }
         auto& getProc(std::size_t i) const { return proc_vars[i]; }
         auto& getHeap() const { return heap; }
 
+        bool operator==(const State& oth) const {
+          return globals == oth.globals &&
+                 proc_vars == oth.proc_vars &&
+                 heap == oth.heap;
+        }
+
         virtual bool need2Store() const { return false; }
         virtual bool ready2explore() const { return true; }
         virtual bool assertViolated() const { return false; }
 
         virtual const Concretizer_ptr getConcretizer() const override { return std::make_shared<MConcretizer>(globals, proc_vars); }
 
+        void serialize(MiniMC::Support::Writer& writer) const override {
+          globals.get().serialize(writer);
+          writer.varint(proc_vars.size());
+          for (auto& vl : proc_vars)
+            vl.get().serialize(writer);
+          heap.get().serialize(writer);
+        }
+
+        /**
+         * Variable frames are interned as a whole. A heap that is not
+         * in the table yet has its chunks interned before it is added,
+         * so heaps differing in a single block share the other blocks.
+         */
+        void intern(MiniMC::CPA::Interner& interner) override {
+          auto& frames = interner.table<VariableLookup>("Variable frames");
+          internFrame(frames, globals);
+          for (auto& vl : proc_vars)
+            internFrame(frames, vl);
+
+          auto& heaps = interner.table<Heap>("Heaps");
+          auto& shared = heap.shared();
+          auto hash = shared->hash();
+          if (auto found = heaps.find(shared, hash)) {
+            heap.share(found);
+          } else {
+            shared->internChunks(interner.table<HeapChunk>("Heap chunks"));
+            heaps.insert(shared, hash);
+          }
+        }
+
+        MiniMC::Hash::hash_t processHash(proc_id id, proc_id, const Relocation&) const override {
+          return proc_vars[id].get().hash(0);
+        }
+
+        std::shared_ptr<MiniMC::CPA::State> permute(const std::vector<proc_id>& perm, const Relocation&) const override {
+          auto res = std::make_shared<State>(*this);
+          for (std::size_t i = 0; i < perm.size(); ++i)
+            res->proc_vars[i] = proc_vars[perm[i]];
+          res->hash_val = 0;
+          return res;
+        }
+
+        static State_ptr deserialize(MiniMC::Support::Reader& reader) {
+          auto globals = VariableLookup::deserialize(reader);
+          std::vector<VariableLookup> procs;
+          auto nbProcs = reader.varint();
+          for (std::size_t i = 0; i < nbProcs; ++i)
+            procs.push_back(VariableLookup::deserialize(reader));
+          auto state = std::make_shared<State>(globals, procs);
+          state->heap = SharedHeap(Heap::deserialize(reader));
+          return state;
+        }
+
       private:
-        VariableLookup globals;
-        std::vector<VariableLookup> proc_vars;
-        Heap heap;
-        mutable MiniMC::Hash::hash_t hash_val = 0;
+        static void internFrame(MiniMC::CPA::InternTable<VariableLookup>& frames, SharedVariableLookup& frame) {
+          frame.share(frames.intern(frame.shared(), frame.get().hash(0)));
+        }
+
+        SharedVariableLookup globals;
+        std::vector<SharedVariableLookup> proc_vars;
+        SharedHeap heap;
+        mutable std::atomic<MiniMC::Hash::hash_t> hash_val = 0;
       };
 
       MiniMC::CPA::State_ptr StateQuery::makeInitialState(const MiniMC::Model::Program& p) {
         VariableLookup globals(p.getGlobals()->getTotalVariables());
         for (auto& v : p.getGlobals()->getVariables()) {
-          globals[v] = MiniMC::Util::Array(v->getType()->getSize());
+          globals.set(v, MiniMC::Util::Array(v->getType()->getSize()));
         }
 
         std::vector<VariableLookup> stack;
@@ -106,8 +191,8 @@ namespace MiniMC {
           stack.emplace_back(vstack->getTotalVariables());
           for (auto& v : vstack->getVariables()) {
             MiniMC::Util::Array arr(v->getType()->getSize());
-            stack.back()[v] = arr;
-            assert(stack.back()[v].getSize() == v->getType()->getSize());
+            stack.back().set(v, arr);
+            assert(stack.back().at(v).getSize() == v->getType()->getSize());
           }
         }
 
@@ -115,18 +200,29 @@ namespace MiniMC {
 
         VMData data{
             .readFrom = {
-                .global = const_cast<VariableLookup*>(&state->getGlobals()),
+                .global = &state->getGlobals(),
                 .local = nullptr,
                 .heap = &state->getHeap()},
             .writeTo = {.global = &state->getGlobals(), .local = nullptr, .heap = &state->getHeap()}};
 
-        auto it = p.getInitialisation().begin();
-        auto end = p.getInitialisation().end();
+        DecodedStream init(p.getInitialisation());
+        auto it = init.begin();
+        auto end = init.end();
         MiniMC::Util::runVM<decltype(it), VMData, ExecuteInstruction>(it, end, data);
 
         return state;
       }
 
+      MiniMC::CPA::State_ptr StateQuery::deserialize(MiniMC::Support::Reader& reader, const MiniMC::Model::Program&) {
+        return State::deserialize(reader);
+      }
+
+      bool Joiner::covers(const MiniMC::CPA::State_ptr& l, const MiniMC::CPA::State_ptr& r) {
+        return static_cast<const State&>(*l) == static_cast<const State&>(*r);
+      }
+
+      Transferer::Transferer() : decoded(std::make_shared<DecodeCache>()) {}
+
       MiniMC::CPA::State_ptr Transferer::doTransfer(const MiniMC::CPA::State_ptr& s, const MiniMC::Model::Edge_ptr& e, proc_id id) {
         auto resstate = s->copy();
         auto& ostate = static_cast<const MiniMC::CPA::Concrete::State&>(*s);
@@ -134,20 +230,20 @@ namespace MiniMC {
 
         VMData data{
             .readFrom = {
-                .global = const_cast<VariableLookup*>(&nstate.getGlobals()),
-                .local = const_cast<VariableLookup*>(&nstate.getProc(id)),
+                .global = &nstate.getGlobals(),
+                .local = &nstate.getProc(id),
                 .heap = &nstate.getHeap()},
             .writeTo = {.global = &nstate.getGlobals(), .local = &nstate.getProc(id), .heap = &nstate.getHeap()}};
 
         if (e->hasAttribute<MiniMC::Model::AttributeType::Instructions>()) {
 
-          auto& instr = e->getAttribute<MiniMC::Model::AttributeType::Instructions>();
+          auto& instr = decoded->get(*e, e->getAttribute<MiniMC::Model::AttributeType::Instructions>());
           try {
 
             if (instr.isPhi) {
-              data.readFrom.global = const_cast<VariableLookup*>(&ostate.getGlobals());
-              data.readFrom.local = const_cast<VariableLookup*>(&ostate.getProc(id));
-              data.readFrom.heap = const_cast<Heap*>(&ostate.getHeap());
+              data.readFrom.global = const_cast<SharedVariableLookup*>(&ostate.getGlobals());
+              data.readFrom.local = const_cast<SharedVariableLookup*>(&ostate.getProc(id));
+              data.readFrom.heap = const_cast<SharedHeap*>(&ostate.getHeap());
             }
             auto it = instr.begin();
             auto end = instr.end();
@@ -0,0 +1,137 @@
+#ifndef _DECODED_IMPL
+#define _DECODED_IMPL
+
+#include "model/cfg.hpp"
+#include "model/instructions.hpp"
+#include "model/variables.hpp"
+#include "util/array.hpp"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace MiniMC {
+  namespace CPA {
+    namespace Concrete {
+
+	  /**
+	   * Operand of a DecodedInstruction. Variables are resolved to
+	   * their frame and index, and constants to their bytes, so
+	   * executing the instruction needs neither virtual calls nor
+	   * casts on the operand.
+	   */
+	  struct Operand {
+		enum class Kind : MiniMC::uint8_t {
+		  Global,
+		  Local,
+		  Immediate,
+		  Undef,
+		  NonCompile
+		};
+
+		static Operand decode (const MiniMC::Model::Value_ptr& v) {
+		  Operand res;
+		  if (v->isVariable ()) {
+			auto var = std::static_pointer_cast<MiniMC::Model::Variable> (v);
+			res.kind = var->isGlobal () ? Kind::Global : Kind::Local;
+			res.index = var->getId ();
+			res.size = var->getType ()->getSize ();
+		  }
+		  else {
+			auto constant = std::static_pointer_cast<MiniMC::Model::Constant> (v);
+			if (constant->isUndef ())
+			  res.kind = Kind::Undef;
+			else if (constant->isNonCompileConstant ())
+			  res.kind = Kind::NonCompile;
+			else {
+			  res.kind = Kind::Immediate;
+			  res.size = constant->getSize ();
+			  res.value = MiniMC::Util::Array (res.size);
+			  res.value.set_block (0,res.size,constant->getData ());
+			}
+		  }
+		  return res;
+		}
+
+		Kind kind = Kind::Immediate;
+		std::size_t index = 0;
+		std::size_t size = 0;
+		MiniMC::Util::Array value;
+	  };
+
+	  /**
+	   * Instruction with its operands decoded. The operands are in the
+	   * order of the Instruction, so the InstHelper of the Instruction
+	   * names them.
+	   */
+	  class DecodedInstruction {
+	  public:
+		DecodedInstruction (const MiniMC::Model::Instruction& inst) : opcode(inst.getOpcode ()), source(&inst) {
+		  for (auto& op : inst)
+			ops.push_back (Operand::decode (op));
+		}
+
+		auto getOpcode () const {return opcode;}
+		auto& getSource () const {return *source;}
+
+		/**
+		 * @return the decoded form of operand \p op of the source Instruction
+		 */
+		const Operand& operand (const MiniMC::Model::Value_ptr& op) const {
+		  return ops[&op - source->getOps ().data ()];
+		}
+
+	  private:
+		MiniMC::Model::InstructionCode opcode;
+		const MiniMC::Model::Instruction* source;
+		std::vector<Operand> ops;
+	  };
+
+	  struct DecodedStream {
+		DecodedStream (const MiniMC::Model::InstructionStream& stream) : isPhi(stream.isPhi) {
+		  instr.reserve (stream.instr.size ());
+		  for (auto& inst : stream)
+			instr.emplace_back (inst);
+		}
+
+		auto begin () const {return instr.begin ();}
+		auto end () const {return instr.end ();}
+
+		std::vector<DecodedInstruction> instr;
+		bool isPhi;
+	  };
+
+	  /**
+	   * Decoded InstructionStreams of the edges seen so far. Each edge
+	   * is decoded the first time it is executed; the edges must not
+	   * change afterwards. Safe to use from several threads.
+	   */
+	  class DecodeCache {
+	  public:
+		const DecodedStream& get (const MiniMC::Model::Edge& edge, const MiniMC::Model::InstructionStream& stream) {
+		  {
+			std::shared_lock lock (mutex);
+			auto it = streams.find (&edge);
+			if (it != streams.end ())
+			  return *it->second;
+		  }
+		  auto decoded = std::make_unique<DecodedStream> (stream);
+		  std::unique_lock lock (mutex);
+		  auto& res = streams[&edge];
+		  if (!res)
+			res = std::move (decoded);
+		  return *res;
+		}
+
+	  private:
+		std::shared_mutex mutex;
+		std::unordered_map<const MiniMC::Model::Edge*, std::unique_ptr<DecodedStream>> streams;
+	  };
+
+	}
+  }
+}
+
+#endif
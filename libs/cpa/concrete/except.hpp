@@ -2,6 +2,7 @@
 #ifndef _EXCEPT__
 #define _EXCEPT__
 
+#include "model/instructions.hpp"
 #include "support/localisation.hpp"
 #include "support/exceptions.hpp"
 
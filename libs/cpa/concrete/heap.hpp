@@ -1,12 +1,16 @@
 #ifndef _HEAP__
 #define _HEAP__
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
+#include "cpa/collapse.hpp"
 #include "support/types.hpp"
 #include "hash/hashing.hpp"
 #include "util/array.hpp"
 #include "support/pointer.hpp"
+#include "support/serialize.hpp"
 #include "except.hpp"
 
 namespace MiniMC {
@@ -16,45 +20,90 @@ namespace MiniMC {
 		InUse = 2,
 		Freed = 4
 	  };
+
+	  /**
+	   * Combine \p digest of the element at \p index into a digest
+	   * that can be updated by adding/subtracting single elements.
+	   */
+	  inline MiniMC::Hash::hash_t slotDigest (MiniMC::uint64_t index, MiniMC::Hash::hash_t digest) {
+		MiniMC::uint64_t buf[2] = {index,digest};
+		return MiniMC::Hash::Hash (buf,2,0);
+	  }
+
+	  /**
+	   * Fixed size piece of a HeapEntry. Chunks are shared between the
+	   * HeapEntries of different states until one of them writes to it.
+	   */
+	  struct HeapChunk {
+		static constexpr MiniMC::uint64_t Size = 256;
+		MiniMC::uint8_t bytes[Size] = {};
+
+		MiniMC::Hash::hash_t hash () const {
+		  return MiniMC::Hash::Hash (bytes,Size,0);
+		}
+
+		bool operator== (const HeapChunk& oth) const {
+		  return std::equal (bytes,bytes+Size,oth.bytes);
+		}
+
+		static const std::shared_ptr<HeapChunk>& zero () {
+		  static const std::shared_ptr<HeapChunk> chunk = std::make_shared<HeapChunk> ();
+		  return chunk;
+		}
+	  };
+	  
 	  struct HeapEntry {
 		HeapEntry (MiniMC::uint64_t size) : state(EntryState::InUse),
-											size(size),
-											memory(new MiniMC::uint8_t[size]) {
-		  std::fill  (memory.get(),memory.get()+size,0);
+											size(0) {
+		  resize (size);
 		}
 											
 		HeapEntry& write (const MiniMC::Util::Array& arr,  MiniMC::uint64_t offset) {
 		  assert(state == EntryState::InUse);
 		  if ( arr.getSize()+offset <= this->size ) {
-			//Copy the existing memory
-			MiniMC::uint8_t* nmem = new MiniMC::uint8_t[this->size];
-			std::copy (memory.get(),memory.get()+this->size,nmem);
-			std::copy (arr.get_direct_access(),arr.get_direct_access()+arr.getSize(),nmem+offset);
-			memory.reset(nmem);
+			auto src = arr.get_direct_access();
+			auto left = arr.getSize();
+			while (left) {
+			  auto index = offset / HeapChunk::Size;
+			  auto inChunk = offset % HeapChunk::Size;
+			  auto len = std::min (left,HeapChunk::Size-inChunk);
+			  auto& chunk = modifyChunk (index);
+			  std::copy (src,src+len,chunk.bytes+inChunk);
+			  updateDigest (index);
+			  src+=len;
+			  offset+=len;
+			  left-=len;
+			}
 			return *this;
 		  }
 		  else  {
-		    throw BufferOverflow();
+			throw BufferOverflow();
 		  }
 		}
 				
-		void read (MiniMC::Util::Array& arr, MiniMC::uint64_t offset) {
+		void read (MiniMC::Util::Array& arr, MiniMC::uint64_t offset) const {
 		  if ( arr.getSize()+offset <= this->size ) {
-		    arr.set_block (0,arr.getSize(),memory.get()+offset);
+			MiniMC::uint64_t done = 0;
+			while (done < arr.getSize ()) {
+			  auto index = offset / HeapChunk::Size;
+			  auto inChunk = offset % HeapChunk::Size;
+			  auto len = std::min (arr.getSize ()-done,HeapChunk::Size-inChunk);
+			  arr.set_block (done,len,chunks[index].chunk->bytes+inChunk);
+			  done+=len;
+			  offset+=len;
+			}
 		  }
 		  else 
 		    throw BufferOverread ();
 		}
 
 		void extend (MiniMC::uint64_t size) {
-		  MiniMC::uint8_t* nmem = new MiniMC::uint8_t[this->size+size];
-		  std::copy (memory.get(),memory.get()+this->size,nmem);
-		  this->size+=size;
-		  memory.reset(nmem);
+		  resize (this->size+size);
 		}
 		
 		auto hash () const {
-		  return MiniMC::Hash::Hash (memory.get(),size,static_cast<MiniMC::Hash::seed_t> (state));
+		  MiniMC::uint64_t buf[3] = {digest,size,static_cast<MiniMC::uint64_t> (state)};
+		  return MiniMC::Hash::Hash (buf,3,0);
 		}
 
 		void setState (EntryState state) {
@@ -64,11 +113,114 @@ namespace MiniMC {
 		auto getSize () const {
 		  return size;
 		}
-		
+
+		bool operator== (const HeapEntry& oth) const {
+		  return state == oth.state &&
+			size == oth.size &&
+			std::equal (chunks.begin(),chunks.end(),oth.chunks.begin(),[](const ChunkRef& l, const ChunkRef& r) {
+			  return l.chunk == r.chunk ||
+				(l.digest == r.digest && std::equal (l.chunk->bytes,l.chunk->bytes+HeapChunk::Size,r.chunk->bytes));
+			});
+		}
+
+		/**
+		 * Chunks that only contain zeros are written as a single
+		 * flag byte, and the last chunk only up to the size of the
+		 * entry.
+		 */
+		void serialize (MiniMC::Support::Writer& writer) const {
+		  writer.byte (static_cast<MiniMC::uint8_t> (state));
+		  writer.varint (size);
+		  for (std::size_t i = 0; i < chunks.size (); ++i) {
+			auto& ref = chunks[i];
+			if (ref.chunk == HeapChunk::zero() ||
+				(ref.digest == zeroDigest () && std::all_of (ref.chunk->bytes,ref.chunk->bytes+HeapChunk::Size,[](auto b) {return b == 0;}))) {
+			  writer.byte (0);
+			}
+			else {
+			  writer.byte (1);
+			  writer.bytes (ref.chunk->bytes,chunkBytes (i));
+			}
+		  }
+		}
+
+		/**
+		 * Replace each chunk by the equal chunk in \p table
+		 */
+		void internChunks (MiniMC::CPA::InternTable<HeapChunk>& table) {
+		  for (auto& ref : chunks)
+			ref.chunk = table.intern (ref.chunk,ref.digest);
+		}
+
+		static HeapEntry deserialize (MiniMC::Support::Reader& reader) {
+		  auto state = static_cast<EntryState> (reader.byte ());
+		  if (state != EntryState::InUse && state != EntryState::Freed)
+			throw MiniMC::Support::SerializationError ("Invalid heap entry state");
+		  HeapEntry entry (reader.varint ());
+		  entry.setState (state);
+		  for (std::size_t i = 0; i < entry.chunks.size (); ++i) {
+			switch (reader.byte ()) {
+			case 0:
+			  break;
+			case 1: {
+			  auto len = entry.chunkBytes (i);
+			  auto src = reader.bytes (len);
+			  std::copy (src,src+len,entry.modifyChunk (i).bytes);
+			  entry.updateDigest (i);
+			  break;
+			}
+			default:
+			  throw MiniMC::Support::SerializationError ("Invalid heap chunk flag");
+			}
+		  }
+		  return entry;
+		}
+
+	  private:
+		struct ChunkRef {
+		  std::shared_ptr<HeapChunk> chunk;
+		  MiniMC::Hash::hash_t digest;
+		};
+
+		static MiniMC::Hash::hash_t zeroDigest () {
+		  static const MiniMC::Hash::hash_t digest = HeapChunk::zero()->hash ();
+		  return digest;
+		}
+
+		/**
+		 * Number of bytes of chunk \p index that are within the entry
+		 */
+		MiniMC::uint64_t chunkBytes (std::size_t index) const {
+		  return std::min (HeapChunk::Size,size - index*HeapChunk::Size);
+		}
+
+		void resize (MiniMC::uint64_t nsize) {
+		  auto nchunks = (nsize + HeapChunk::Size - 1) / HeapChunk::Size;
+		  for (auto i = chunks.size (); i < nchunks; ++i) {
+			chunks.push_back ({HeapChunk::zero(),zeroDigest ()});
+			digest += slotDigest (i,zeroDigest ());
+		  }
+		  size = nsize;
+		}
+
+		HeapChunk& modifyChunk (std::size_t index) {
+		  auto& ref = chunks[index];
+		  if (ref.chunk.use_count () > 1)
+			ref.chunk = std::make_shared<HeapChunk> (*ref.chunk);
+		  return *ref.chunk;
+		}
+
+		void updateDigest (std::size_t index) {
+		  auto& ref = chunks[index];
+		  digest -= slotDigest (index,ref.digest);
+		  ref.digest = ref.chunk->hash ();
+		  digest += slotDigest (index,ref.digest);
+		}
+
 		EntryState state;
 		MiniMC::uint64_t size;
-		std::shared_ptr<MiniMC::uint8_t[]> memory;
-		
+		std::vector<ChunkRef> chunks;
+		MiniMC::Hash::hash_t digest = 0;
 	  };
 	  
 
@@ -96,6 +248,7 @@ namespace MiniMC {
 		MiniMC::pointer_t allocate (MiniMC::uint64_t size) {
 		  auto pointer = MiniMC::Support::makeHeapPointer (entries.size(),0);
 		  entries.emplace_back (size);
+		  digest += slotDigest (entries.size()-1,entries.back().hash ());
 		  return pointer;
 		}
 
@@ -105,7 +258,7 @@ namespace MiniMC {
 		  if (base < entries.size () && offset == 0) {
 			auto& entry = entries.at(base);
 			auto pointer = MiniMC::Support::makeHeapPointer (base,entry.getSize());
-			entry.extend (size);
+			update (base,[size](HeapEntry& entry) {entry.extend (size);});
 			return pointer;
 			
 		  }
@@ -119,14 +272,14 @@ namespace MiniMC {
 		  auto offset = MiniMC::Support::getOffset(pointer);
 		  if (base < entries.size() &&
 			  offset == 0) {
-			entries.at(base).setState (EntryState::Freed);
+			update (base,[](HeapEntry& entry) {entry.setState (EntryState::Freed);});
 		  }
 		  else {
 			throw InvalidFree ();
 		  }
 		}
 
-		void read (MiniMC::Util::Array& arr, MiniMC::pointer_t pointer) {
+		void read (MiniMC::Util::Array& arr, MiniMC::pointer_t pointer) const {
 		  auto base = MiniMC::Support::getBase(pointer);
 		  auto offset = MiniMC::Support::getOffset(pointer);
 		  if (base < entries.size()) {
@@ -142,7 +295,7 @@ namespace MiniMC {
 		  auto base = MiniMC::Support::getBase(pointer);
 		  auto offset = MiniMC::Support::getOffset(pointer);
 		  if (base < entries.size()) {
-			entries.at(base).write (arr,offset);
+			update (base,[&arr,offset](HeapEntry& entry) {entry.write (arr,offset);});
 		  }
 		  
 		  else {
@@ -150,16 +303,56 @@ namespace MiniMC {
 		  }
 		}
 		
+		bool operator== (const Heap& oth) const {
+		  return digest == oth.digest && entries == oth.entries;
+		}
+
+		/**
+		 * The hash is maintained while the heap is modified, so
+		 * this does not touch the contents of the entries
+		 */
 		auto hash () const {
-		  MiniMC::Hash::seed_t seed = 0;
-		  for (auto& entryt : entries) {
-			MiniMC::Hash::hash_combine (seed,entryt);
+		  MiniMC::uint64_t buf[2] = {digest,entries.size ()};
+		  return MiniMC::Hash::Hash (buf,2,0);
+		}
+
+		void serialize (MiniMC::Support::Writer& writer) const {
+		  writer.varint (entries.size ());
+		  for (auto& entry : entries)
+			entry.serialize (writer);
+		}
+
+		/**
+		 * Share equal chunks with the heaps already in \p table. Does
+		 * not change the contents, so it may be called on a heap
+		 * shared by several States.
+		 */
+		void internChunks (MiniMC::CPA::InternTable<HeapChunk>& table) {
+		  for (auto& entry : entries)
+			entry.internChunks (table);
+		}
+
+		static Heap deserialize (MiniMC::Support::Reader& reader) {
+		  Heap heap;
+		  auto nbEntries = reader.varint ();
+		  for (std::size_t i = 0; i < nbEntries; ++i) {
+			heap.entries.push_back (HeapEntry::deserialize (reader));
+			heap.digest += slotDigest (i,heap.entries.back().hash ());
 		  }
-		  return seed;
+		  return heap;
 		}
 		
 	  private:
+		template<class Func>
+		void update (std::size_t base, Func func) {
+		  auto& entry = entries.at(base);
+		  digest -= slotDigest (base,entry.hash ());
+		  func (entry);
+		  digest += slotDigest (base,entry.hash ());
+		}
+		
 		std::vector<HeapEntry> entries;
+		MiniMC::Hash::hash_t digest = 0;
 	  };
 		
 	}
@@ -6,6 +6,7 @@
 
 #include "model/variables.hpp"
 #include "util/array.hpp"
+#include "util/cow.hpp"
 #include "support/types.hpp"
 
 #include "support/random.hpp"
@@ -14,60 +15,149 @@
 #include "cmpimpl.hpp"
 #include "castimpl.hpp"
 #include "heap.hpp"
+#include "decoded.hpp"
+
+#include <ostream>
+#include <vector>
 
 
 namespace MiniMC {
   namespace CPA {
     namespace Concrete {
 
-	  using VariableLookup = MiniMC::Model::VariableMap<MiniMC::Util::Array>;
-	  
+	  /**
+	   * Values of the variables of one frame. Besides the values it
+	   * keeps the sum of a digest per variable, so overwriting a
+	   * variable only rehashes that variable.
+	   */
+	  class VariableLookup {
+	  public:
+		VariableLookup (std::size_t size) : values(size), digests(size) {
+		  auto empty = MiniMC::Util::Array{}.hash (0);
+		  for (std::size_t i = 0; i < size; ++i) {
+			digests[i] = empty;
+			digest += slotDigest (i,empty);
+		  }
+		}
+
+		const MiniMC::Util::Array& at (const MiniMC::Model::Variable_ptr& v) const {
+		  return values.at (v);
+		}
+
+		void set (const MiniMC::Model::Variable_ptr& v, const MiniMC::Util::Array& arr) {
+		  setIndex (MiniMC::Model::VariablePtrIndexer{} (v),arr);
+		}
+
+		const MiniMC::Util::Array& atIndex (std::size_t index) const {
+		  return values.atIndex (index);
+		}
+
+		void setIndex (std::size_t index, const MiniMC::Util::Array& arr) {
+		  auto ndigest = arr.hash (0);
+		  digest -= slotDigest (index,digests[index]);
+		  digest += slotDigest (index,ndigest);
+		  digests[index] = ndigest;
+		  values.atIndex (index) = arr;
+		}
+
+		MiniMC::Hash::hash_t hash (MiniMC::Hash::seed_t seed) const {
+		  MiniMC::uint64_t buf[2] = {seed,digest};
+		  return MiniMC::Hash::Hash (buf,2,0);
+		}
+
+		std::ostream& output (std::ostream& os) const {
+		  return values.output (os);
+		}
+
+		bool operator== (const VariableLookup& oth) const {
+		  return digest == oth.digest && values == oth.values;
+		}
+
+		void serialize (MiniMC::Support::Writer& writer) const {
+		  writer.varint (values.getSize ());
+		  for (std::size_t i = 0; i < values.getSize (); ++i) {
+			auto& val = values.atIndex (i);
+			writer.varint (val.getSize ());
+			writer.bytes (val.get_direct_access (),val.getSize ());
+		  }
+		}
+
+		static VariableLookup deserialize (MiniMC::Support::Reader& reader) {
+		  VariableLookup lookup (reader.varint ());
+		  for (std::size_t i = 0; i < lookup.values.getSize (); ++i) {
+			auto size = reader.varint ();
+			auto src = reader.bytes (size);
+			MiniMC::Util::Array arr (size);
+			arr.set_block (0,size,src);
+			lookup.setIndex (i,arr);
+		  }
+		  return lookup;
+		}
+
+	  private:
+		MiniMC::Model::VariableMap<MiniMC::Util::Array> values;
+		std::vector<MiniMC::Hash::hash_t> digests;
+		MiniMC::Hash::hash_t digest = 0;
+	  };
+
+	  inline std::ostream& operator<< (std::ostream& os, const VariableLookup& lookup) {
+		return lookup.output (os);
+	  }
+
+	  using SharedVariableLookup = MiniMC::Util::CopyOnWrite<VariableLookup>;
+	  using SharedHeap = MiniMC::Util::CopyOnWrite<Heap>;
+
+	  /**
+	   * View of the variables and heap of a State. Reads go through
+	   * the shared data, while writes first take a private copy of the
+	   * variable frame (or heap) they modify.
+	   */
 	  struct GlobalLocalVariableLookup{
-		VariableLookup* global;
-		VariableLookup* local;
-		Heap* heap;
-		auto LookUp (const MiniMC::Model::Variable_ptr& v) const  {
+		SharedVariableLookup* global;
+		SharedVariableLookup* local;
+		SharedHeap* heap;
+		const MiniMC::Util::Array& LookUp (const MiniMC::Model::Variable_ptr& v) const  {
 		  if (v->isGlobal ()) {
-			return global->at (v);
+			return global->get().at (v);
 		  }
 		  else
-			return local->at (v);
+			return local->get().at (v);
 		}
 		
 		void set (const MiniMC::Model::Variable_ptr& v, const MiniMC::Util::Array& arr) {
 		  assert (v->getType ()->getSize () == arr.getSize ());
 		  if (v->isGlobal ()) {
-			(*global)[v] = arr;
+			global->modify().set (v,arr);
 		  }
 		  else  {
 			assert(arr.getSize () == v->getType ()->getSize ());
 			
-			(*local)[v] = arr;
+			local->modify().set (v,arr);
 		  }
 		}
 
-		const MiniMC::Util::Array evaluate (const MiniMC::Model::Value_ptr& v) const {
-		  if (v->isVariable ()) {
-			auto var =  std::static_pointer_cast<MiniMC::Model::Variable> (v);
-			auto arr = LookUp (var);
-			assert(arr.getSize () == v->getType ()->getSize ());
-			return arr;
+		const MiniMC::Util::Array& evaluate (const Operand& op) const {
+		  switch (op.kind) {
+		  case Operand::Kind::Global:
+			return global->get().atIndex (op.index);
+		  case Operand::Kind::Local:
+			return local->get().atIndex (op.index);
+		  case Operand::Kind::Undef:
+			throw MiniMC::Support::Exception ("No Evaluation of Undef constants available");
+		  case Operand::Kind::NonCompile:
+			throw MiniMC::Support::Exception ("No Evaluation of Noncompile constants available");
+		  default:
+			return op.value;
 		  }
+		}
+
+		void set (const Operand& op, const MiniMC::Util::Array& arr) {
+		  assert (op.size == arr.getSize ());
+		  if (op.kind == Operand::Kind::Global)
+			global->modify().setIndex (op.index,arr);
 		  else {
-		    auto constant = std::static_pointer_cast<MiniMC::Model::Constant> (v);
-		    if (constant -> isUndef ()) {
-		      throw MiniMC::Support::Exception ("No Evaluation of Undef constants available");
-			
-		    }
-		    else if (constant->isNonCompileConstant ()) {
-		      throw MiniMC::Support::Exception ("No Evaluation of Noncompile constants available");
-		    }
-		    else {
-		      MiniMC::Util::Array arr(constant->getSize ());
-		      arr.set_block (0,constant->getSize (),constant->getData ());
-		      return arr;
-		    }
-		    
+			assert (op.kind == Operand::Kind::Local);
+			local->modify().setIndex (op.index,arr);
 		  }
 		}
 		
@@ -79,58 +169,63 @@ namespace MiniMC {
 	    void finalise () {}
 	  };
 	  
+	  /**
+	   * Executes DecodedInstructions. The InstHelper of the source
+	   * Instruction only names the operands; their values are read
+	   * through the decoded Operands.
+	   */
 	  struct ExecuteInstruction {
 
 		template<MiniMC::Model::InstructionCode opc>
 		static void execute (VMData& data,
-							 const MiniMC::Model::Instruction& i)  {
-		  MiniMC::Model::InstHelper<opc> helper (i);
+							 const DecodedInstruction& i)  {
+		  MiniMC::Model::InstHelper<opc> helper (i.getSource ());
 		  if constexpr (MiniMC::Model::InstructionData<opc>::isTAC) {
-			auto& res = helper.getResult ();
-			auto& left = helper.getLeftOp ();
-			auto& right = helper.getRightOp ();
+			auto& res = i.operand (helper.getResult ());
+			auto& left = i.operand (helper.getLeftOp ());
+			auto& right = i.operand (helper.getRightOp ());
 
-			auto lval = data.readFrom.evaluate (left);
-			auto rval = data.readFrom.evaluate (right);
-			data.writeTo .set (std::static_pointer_cast<MiniMC::Model::Variable> (res), Steptacexec<opc> (lval,rval));
+			auto& lval = data.readFrom.evaluate (left);
+			auto& rval = data.readFrom.evaluate (right);
+			data.writeTo .set (res, Steptacexec<opc> (lval,rval));
 			
 		  }
 		  
 		  else if constexpr (MiniMC::Model::InstructionData<opc>::isComparison) {
-			auto& res = helper.getResult ();
-			auto& left = helper.getLeftOp ();
-			auto& right = helper.getRightOp ();
+			auto& res = i.operand (helper.getResult ());
+			auto& left = i.operand (helper.getLeftOp ());
+			auto& right = i.operand (helper.getRightOp ());
 			 
-			auto lval = data.readFrom.evaluate (left);
-			auto rval = data.readFrom.evaluate (right);
-			assert(lval.getSize () == left->getType()->getSize ());
-			data.writeTo .set (std::static_pointer_cast<MiniMC::Model::Variable> (res), Stepcmpexec<opc> (lval,rval));
+			auto& lval = data.readFrom.evaluate (left);
+			auto& rval = data.readFrom.evaluate (right);
+			assert(lval.getSize () == left.size);
+			data.writeTo .set (res, Stepcmpexec<opc> (lval,rval));
 			
 		  }
 
 		  else if constexpr (MiniMC::Model::InstructionData<opc>::isPredicate) {
-			 auto& left = helper.getLeftOp ();
-			 auto& right = helper.getRightOp ();
+			 auto& left = i.operand (helper.getLeftOp ());
+			 auto& right = i.operand (helper.getRightOp ());
 			 
-			 auto lval = data.readFrom.evaluate (left);
-			 auto rval = data.readFrom.evaluate (right);
+			 auto& lval = data.readFrom.evaluate (left);
+			 auto& rval = data.readFrom.evaluate (right);
 			 Steppredexec<opc> (lval,rval);
 			 
 		  }
 		  
 		  else if constexpr (MiniMC::Model::InstructionData<opc>::isCast) {
-			auto& res = helper.getResult ();
-			auto& left = helper.getCastee ();
-			auto lval = data.readFrom.evaluate (left);
-			data.writeTo .set (std::static_pointer_cast<MiniMC::Model::Variable> (res), Stepcastexec1<opc> (lval,res->getType()->getSize()));
+			auto& res = i.operand (helper.getResult ());
+			auto& left = i.operand (helper.getCastee ());
+			auto& lval = data.readFrom.evaluate (left);
+			data.writeTo .set (res, Stepcastexec1<opc> (lval,res.size));
 			
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Assign) {
-			auto& res = helper.getResult ();
-			auto& left = helper.getValue ();
-			auto lval = data.readFrom.evaluate (left);
-			data.writeTo .set (std::static_pointer_cast<MiniMC::Model::Variable> (res), lval);
+			auto& res = i.operand (helper.getResult ());
+			auto& left = i.operand (helper.getValue ());
+			auto& lval = data.readFrom.evaluate (left);
+			data.writeTo .set (res, lval);
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Skip) {
@@ -138,28 +233,28 @@ namespace MiniMC {
 		  }
 		   
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Assume) {
-			auto& val = helper.getAssert ();
-			auto lval = data.readFrom.evaluate (val);
+			auto& val = i.operand (helper.getAssert ());
+			auto& lval = data.readFrom.evaluate (val);
 			if (!lval.template read<MiniMC::uint8_t> ())
 			  throw MiniMC::Support::AssumeViolated ();
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Uniform) {
-			auto& res = helper.getResult ();
-			auto& min = helper.getMin ();
-			auto& max = helper.getMax ();
+			auto& res = i.operand (helper.getResult ());
+			auto& min = i.operand (helper.getMin ());
+			auto& max = i.operand (helper.getMax ());
 			
-			auto lmin = data.readFrom.evaluate (min);
-			auto lmax = data.readFrom.evaluate (max);
+			auto& lmin = data.readFrom.evaluate (min);
+			auto& lmax = data.readFrom.evaluate (max);
 
 			
 			auto mod = [&]<typename T> () {
 			  MiniMC::Util::Array arrres (sizeof (T));
 			  arrres.template set<T> (0,MiniMC::Support::RandomNumber{}.uniform (lmin.template read<T>(), lmax.template read<T>()));;
-			  data.writeTo.set (std::static_pointer_cast<MiniMC::Model::Variable> (res),arrres);
+			  data.writeTo.set (res,arrres);
 			};
 			
-			switch (res->getType()->getSize ()) {
+			switch (res.size) {
 			case 1:
 			  mod.template operator()<MiniMC::uint8_t> ();
 			  break;
@@ -177,15 +272,15 @@ namespace MiniMC {
 		  }
 		  
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Assert) {
-			auto& val = helper.getAssert ();
-			auto lval = data.readFrom.evaluate (val);
+			auto& val = i.operand (helper.getAssert ());
+			auto& lval = data.readFrom.evaluate (val);
 			if (!lval.template read<MiniMC::uint8_t> ())
 			  throw MiniMC::Support::AssertViolated ();
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::NegAssume) {
-			auto& val = helper.getAssert ();
-			auto lval = data.readFrom.evaluate (val);
+			auto& val = i.operand (helper.getAssert ());
+			auto& lval = data.readFrom.evaluate (val);
 			if (lval.template read<MiniMC::uint8_t> ())
 			  throw MiniMC::Support::AssumeViolated ();
 		  }
@@ -195,68 +290,67 @@ namespace MiniMC {
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Free) {
-			auto& pointer = helper.getPointer ();
-			auto lpointer = data.readFrom.evaluate (pointer);
-			data.writeTo.heap->free (lpointer.template read<pointer_t> ());
+			auto& pointer = i.operand (helper.getPointer ());
+			auto lpointer = data.readFrom.evaluate (pointer).template read<pointer_t> ();
+			data.writeTo.heap->modify().free (lpointer);
 		  }
 		  
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Alloca ||
 							 opc == MiniMC::Model::InstructionCode::FindSpace) {
-			auto& result = helper.getResult ();
-			auto& size = helper.getSize ();
-			auto lsize = data.readFrom.evaluate (size);
-			MiniMC::pointer_t pointer = data.writeTo.heap->allocate (lsize.template read<MiniMC::uint64_t> (0));
+			auto& result = i.operand (helper.getResult ());
+			auto& size = i.operand (helper.getSize ());
+			auto lsize = data.readFrom.evaluate (size).template read<MiniMC::uint64_t> (0);
+			MiniMC::pointer_t pointer = data.writeTo.heap->modify().allocate (lsize);
 			MiniMC::Util::Array res (sizeof(pointer));
 			res.set (0,pointer);
-			data.writeTo.set (std::static_pointer_cast<MiniMC::Model::Variable> (result),res);
+			data.writeTo.set (result,res);
 			
 		  }
 		  
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::ExtendObj) {
-			auto& result = helper.getResult ();
-			auto& size = helper.getSize ();
-			auto lsize = data.readFrom.evaluate (size);
-			auto& pointer = helper.getPointer ();
-			auto lpointer = data.readFrom.evaluate (pointer);
+			auto& result = i.operand (helper.getResult ());
+			auto& size = i.operand (helper.getSize ());
+			auto lsize = data.readFrom.evaluate (size).template read<MiniMC::uint64_t> (0);
+			auto& pointer = i.operand (helper.getPointer ());
+			auto lpointer = data.readFrom.evaluate (pointer).template read<pointer_t> ();
 			
-			MiniMC::pointer_t pointer_res = data.writeTo.heap->extend (lpointer.template read<pointer_t> (),
-																	   lsize.template read<MiniMC::uint64_t> (0));
+			MiniMC::pointer_t pointer_res = data.writeTo.heap->modify().extend (lpointer,lsize);
 			MiniMC::Util::Array res (sizeof(pointer_res));
 			res.set (0,pointer_res);
-			data.writeTo.set (std::static_pointer_cast<MiniMC::Model::Variable> (result),res);
+			data.writeTo.set (result,res);
 			
 		  }
 		  
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Store) {
-			auto addr = data.readFrom.evaluate (helper.getAddress ());
-			auto value = data.readFrom.evaluate (helper.getValue ());
-			data.writeTo.heap->write (value,addr.template read<MiniMC::pointer_t> ());
+			auto addr = data.readFrom.evaluate (i.operand (helper.getAddress ())).template read<MiniMC::pointer_t> ();
+			auto& value = data.readFrom.evaluate (i.operand (helper.getValue ()));
+			data.writeTo.heap->modify().write (value,addr);
 			
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Load) {
-			auto& result = helper.getResult ();
-			MiniMC::Util::Array res (result->getType ()->getSize());
-			auto addr = data.readFrom.evaluate (helper.getAddress ());
-			data.readFrom.heap->read (res,addr.template read<MiniMC::pointer_t> ());
-			data.writeTo.set (std::static_pointer_cast<MiniMC::Model::Variable> (result),res);
+			auto& result = i.operand (helper.getResult ());
+			MiniMC::Util::Array res (result.size);
+			auto addr = data.readFrom.evaluate (i.operand (helper.getAddress ())).template read<MiniMC::pointer_t> ();
+			data.readFrom.heap->get().read (res,addr);
+			data.writeTo.set (result,res);
 			
 		  }
 
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::PtrAdd) {
-			auto& result = helper.getResult ();
-			auto addr = data.readFrom.evaluate (helper.getAddress ());
-			auto value = data.readFrom.evaluate (helper.getValue ());
-			auto skip = data.readFrom.evaluate (helper.getSkipSize ());
+			auto& result = i.operand (helper.getResult ());
+			auto addr = data.readFrom.evaluate (i.operand (helper.getAddress ())).template read<MiniMC::pointer_t> ();
+			auto value = data.readFrom.evaluate (i.operand (helper.getValue ())).template read<MiniMC::uint64_t> ();
+			auto skip = data.readFrom.evaluate (i.operand (helper.getSkipSize ())).template read<MiniMC::uint64_t> ();
 
-			MiniMC::uint64_t jump = value.template read<MiniMC::uint64_t> ()* skip.template read<MiniMC::uint64_t> ();
-			MiniMC::pointer_t resptr = MiniMC::Support::ptradd (addr.template read<MiniMC::pointer_t> (),jump);
+			MiniMC::uint64_t jump = value * skip;
+			MiniMC::pointer_t resptr = MiniMC::Support::ptradd (addr,jump);
 
 			MiniMC::Util::Array res (sizeof(MiniMC::pointer_t));
 			res.set (0,resptr);
 			
 			
-			data.writeTo.set (std::static_pointer_cast<MiniMC::Model::Variable> (result),res);
+			data.writeTo.set (result,res);
 			
 		  }
 		  
@@ -274,7 +368,7 @@ namespace MiniMC {
 namespace std {
   template<>
   struct hash<MiniMC::CPA::Concrete::VariableLookup > {
-	auto operator() (const MiniMC::CPA::Concrete::VariableLookup& arr) {
+	auto operator() (const MiniMC::CPA::Concrete::VariableLookup& arr) const {
 	  return arr.hash (0);
 	}
   };
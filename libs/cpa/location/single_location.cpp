@@ -60,6 +60,10 @@ namespace MiniMC {
           return nullptr;
         }
 
+        bool operator==(const State& oth) const {
+          return location == oth.location && ready == oth.ready;
+        }
+
       private:
         MiniMC::Model::Location* location;
         bool ready;
@@ -99,6 +103,10 @@ namespace MiniMC {
         return std::make_shared<State>(locs[0]);
       }
 
+      bool Joiner::covers(const State_ptr& l, const State_ptr& r) {
+        return static_cast<const State&>(*l) == static_cast<const State&>(*r);
+      }
+
       State_ptr Joiner::doJoin(const State_ptr& l, const State_ptr& r) {
         auto lstate = std::static_pointer_cast<const State>(l);
         auto rstate = std::static_pointer_cast<const State>(r);
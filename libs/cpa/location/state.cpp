@@ -3,6 +3,7 @@
 #include "hash/hashing.hpp"
 #include "model/cfg.hpp"
 #include "support/pointer.hpp"
+#include <algorithm>
 
 namespace MiniMC {
   namespace CPA {
@@ -34,6 +35,10 @@ namespace MiniMC {
           return s;
         }
 
+        bool operator==(const LocationState& oth) const {
+          return stack == oth.stack;
+        }
+
         std::vector<MiniMC::Model::Location*> stack;
       };
     } // namespace Location
@@ -107,6 +112,37 @@ namespace MiniMC {
           return false;
         }
 
+        bool operator==(const State& oth) const {
+          return locations == oth.locations;
+        }
+
+        void serialize(MiniMC::Support::Writer& writer) const override {
+          writer.varint(locations.size());
+          for (auto& locState : locations) {
+            writer.varint(locState.stack.size());
+            for (auto loc : locState.stack) {
+              writer.varint(loc->getCFG()->getFunction()->getID());
+              writer.varint(loc->getID());
+            }
+          }
+        }
+
+        MiniMC::Hash::hash_t processHash(proc_id id, proc_id as, const Relocation& reloc) const override {
+          MiniMC::Hash::hash_t s = 0;
+          for (auto loc : locations[id].stack)
+            MiniMC::Hash::hash_combine(s, *reloc(loc, id, as));
+          return s;
+        }
+
+        std::shared_ptr<MiniMC::CPA::State> permute(const std::vector<proc_id>& perm, const Relocation& reloc) const override {
+          std::vector<LocationState> res(locations.size());
+          for (std::size_t i = 0; i < res.size(); ++i) {
+            for (auto loc : locations[perm[i]].stack)
+              res[i].push(reloc(loc, perm[i], i));
+          }
+          return std::make_shared<State>(res);
+        }
+
       private:
         std::vector<LocationState> locations;
         std::vector<bool> ready;
@@ -153,11 +189,44 @@ namespace MiniMC {
         return std::make_shared<State>(locs);
       }
 
+      bool MiniMC::CPA::Location::Joiner::covers(const State_ptr& l, const State_ptr& r) {
+        return static_cast<const State&>(*l) == static_cast<const State&>(*r);
+      }
+
       size_t MiniMC::CPA::Location::StateQuery::nbOfProcesses(const State_ptr& s) {
         auto state = static_cast<const State*>(s.get());
         return state->nbOfProcesses();
       }
 
+      namespace {
+        MiniMC::Model::Location* findLocation(const MiniMC::Model::Program& prgm, MiniMC::func_t func, std::size_t id) {
+          if (!prgm.functionExists(func))
+            throw MiniMC::Support::SerializationError("Unknown function in serialized State");
+          auto& locations = prgm.getFunction(func)->getCFG()->getLocations();
+          // Ids are assigned as positions, which only go stale if locations were removed from the CFG
+          if (id < locations.size() && locations[id]->getID() == id)
+            return locations[id].get();
+          auto it = std::find_if(locations.begin(), locations.end(), [id](auto& loc) { return loc->getID() == id; });
+          if (it == locations.end())
+            throw MiniMC::Support::SerializationError("Unknown location in serialized State");
+          return it->get();
+        }
+      } // namespace
+
+      State_ptr MiniMC::CPA::Location::StateQuery::deserialize(MiniMC::Support::Reader& reader, const MiniMC::Model::Program& prgm) {
+        std::vector<LocationState> locs(reader.varint());
+        for (auto& locState : locs) {
+          auto depth = reader.varint();
+          if (!depth)
+            throw MiniMC::Support::SerializationError("Empty call stack in serialized State");
+          for (std::size_t i = 0; i < depth; ++i) {
+            auto func = reader.varint();
+            locState.push(findLocation(prgm, func, reader.varint()));
+          }
+        }
+        return std::make_shared<State>(locs);
+      }
+
       MiniMC::Model::Location_ptr MiniMC::CPA::Location::StateQuery::getLocation(const State_ptr& s, proc_id id) {
         auto state = static_cast<const State*>(s.get());
         return state->getLocation(id);
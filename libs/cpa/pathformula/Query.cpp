@@ -41,6 +41,7 @@ namespace MiniMC {
         auto it = prgm.getInitialisation().begin();
         auto end = prgm.getInitialisation().end();
         MiniMC::Util::runVM<decltype(it), VMData, ExecuteInstruction>(it, end, data);
+        state->extendPath(data.path, std::move(data.conjuncts));
 
         return state;
       }
@@ -61,7 +62,7 @@ namespace MiniMC {
         MiniMC::Util::SSAMap nmap = MiniMC::Util::SSAMap::merge(left.getSSAMap(), right.getSSAMap(), mergeOp);
         MiniMC::Util::SSAMap ngmap = MiniMC::Util::SSAMap::merge(left.getGSSAMap(), right.getGSSAMap(), mergeOp);
 
-        return std::make_shared<MiniMC::CPA::PathFormula::State>(nmap, ngmap, left.getContext(), mergeOp(left.getPathFormula(), right.getPathFormula()));
+        return std::make_shared<MiniMC::CPA::PathFormula::State>(nmap, ngmap, left.getContext(), mergeOp(left.getPathFormula(), right.getPathFormula()), left.getSession());
       }
 
       MiniMC::CPA::State_ptr Transferer::doTransfer(const State_ptr& s, const MiniMC::Model::Edge_ptr& e, proc_id id) {
@@ -93,7 +94,7 @@ namespace MiniMC {
             auto it = instr.begin();
             auto end = instr.end();
             MiniMC::Util::runVM<decltype(it), VMData, ExecuteInstruction>(it, end, data);
-            nState.getPathFormula() = data.path;
+            nState.extendPath(data.path, std::move(data.conjuncts));
 
           } catch (MiniMC::Support::AssumeViolated) {
             return nullptr;
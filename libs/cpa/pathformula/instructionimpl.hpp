@@ -3,6 +3,7 @@
 
 #include "util/ssamap.hpp"
 #include "util/smtconstruction.hpp"
+#include <vector>
 
 #include "heap.hpp"
 
@@ -23,6 +24,16 @@ namespace MiniMC {
 	
 	SMTLib::TermBuilder* smtbuilder;
 	SMTLib::Term_ptr path;
+	std::vector<SMTLib::Term_ptr> conjuncts;
+	
+	/**
+	 * Conjoin \p term to the path formula and remember it as one of
+	 * the conjuncts added by this run
+	 */
+	void conjoin (const SMTLib::Term_ptr& term) {
+	  path = smtbuilder->buildTerm(SMTLib::Ops::And,{path,term});
+	  conjuncts.push_back (term);
+	}
 	void finalise() {}
       };
 	  
@@ -57,7 +68,7 @@ namespace MiniMC {
 			auto leftTerm = MiniMC::Util::buildSMTTerm (*data.oldSSAMap,*data.oldGSSAMap,*data.smtbuilder,left);//data.oldSSAMap->lookup (left.get());
 			auto rightTerm = MiniMC::Util::buildSMTTerm (*data.oldSSAMap,*data.oldGSSAMap,*data.smtbuilder,right);
 			auto conjunct = data.smtbuilder->buildTerm (smtop,{leftTerm,rightTerm});
-			data.path = data.smtbuilder->buildTerm(SMTLib::Ops::And,{data.path,conjunct});
+			data.conjoin (conjunct);
 	  
 		  }
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::Assign) {
@@ -71,14 +82,14 @@ namespace MiniMC {
 			MiniMC::Model::InstHelper<opc> helper (i);
 			auto assert = helper.getAssert ();
 			auto assertTerm = MiniMC::Util::buildSMTTerm (*data.oldSSAMap,*data.oldGSSAMap,*data.smtbuilder,assert);
-			data.path = data.smtbuilder->buildTerm(SMTLib::Ops::And,{data.path,assertTerm});
+			data.conjoin (assertTerm);
 		  }
 		  else if constexpr (opc == MiniMC::Model::InstructionCode::NegAssume) {
 			MiniMC::Model::InstHelper<opc> helper (i);
 			auto assert = helper.getAssert ();
 			auto assertTerm = MiniMC::Util::buildSMTTerm (*data.oldSSAMap,*data.oldGSSAMap,*data.smtbuilder,assert);
 			auto notted = data.smtbuilder->buildTerm(SMTLib::Ops::Not,{assertTerm});
-			data.path = data.smtbuilder->buildTerm(SMTLib::Ops::And,{data.path,notted});
+			data.conjoin (notted);
 		    
 		  }
 
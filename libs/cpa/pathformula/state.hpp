@@ -2,7 +2,11 @@
 #define _pathSTATE__
 
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 #include "support/feedback.hpp"
+#include "support/timing.hpp"
 #include "util/ssamap.hpp"
 #include "cpa/interface.hpp"
 #include "smt/context.hpp"
@@ -14,10 +18,84 @@ namespace MiniMC {
     namespace PathFormula {
 
 	  
+	  /**
+	   * Conjuncts added to the path formula by one transfer. Segments
+	   * are linked to the segment of the predecessor, so the States
+	   * along a search path share their prefix.
+	   */
+	  struct PathSegment {
+		std::shared_ptr<const PathSegment> parent;
+		std::vector<SMTLib::Term_ptr> conjuncts;
+		std::size_t depth;
+		// Result of checking the path ending here, guarded by the SolverSession
+		mutable std::optional<MiniMC::CPA::Concretizer::Feasibility> feasibility;
+	  };
+
+	  using PathSegment_ptr = std::shared_ptr<const PathSegment>;
+
+	  /**
+	   * Incremental solver shared by all States derived from the same
+	   * initial State. Each asserted PathSegment lives in its own
+	   * push/pop scope, so checking a path only pops the segments that
+	   * are not a prefix of it and asserts the segments that are new.
+	   */
+	  class SolverSession {
+	  public:
+		SolverSession (const SMTLib::Context_ptr& context) : solver(context->makeSolver ()) {}
+
+		MiniMC::CPA::Concretizer::Feasibility check (const PathSegment_ptr& path) {
+		  using Feasibility = MiniMC::CPA::Concretizer::Feasibility;
+		  std::scoped_lock lock (mutex);
+		  if (path->feasibility)
+			return *path->feasibility;
+		  if (path->parent && path->parent->feasibility == Feasibility::Infeasible) {
+			path->feasibility = Feasibility::Infeasible;
+			return Feasibility::Infeasible;
+		  }
+
+		  std::vector<PathSegment_ptr> fresh;
+		  auto seg = path;
+		  for (; seg && (seg->depth >= asserted.size () || asserted[seg->depth] != seg); seg = seg->parent)
+			fresh.push_back (seg);
+		  auto common = seg ? seg->depth + 1 : 0;
+		  for (; asserted.size () > common; asserted.pop_back ())
+			solver->pop ();
+		  for (auto it = fresh.rbegin (); it != fresh.rend (); ++it) {
+			solver->push ();
+			for (auto& conjunct : (*it)->conjuncts)
+			  solver->assert_formula (conjunct);
+			asserted.push_back (*it);
+		  }
+
+		  MiniMC::Support::getMessager ().message ("Running SMT Solver");
+		  MiniMC::Support::Phase phase ("SMT check_sat");
+		  switch (solver->check_sat ()) {
+		  case SMTLib::Result::Satis:
+			path->feasibility = Feasibility::Feasible;
+			break;
+		  case SMTLib::Result::NSatis:
+			path->feasibility = Feasibility::Infeasible;
+			break;
+		  default:
+			path->feasibility = Feasibility::Unknown;
+		  }
+		  return *path->feasibility;
+		}
+
+	  private:
+		SMTLib::Solver_ptr solver;
+		std::vector<PathSegment_ptr> asserted;
+		std::mutex mutex;
+	  };
+
+	  using SolverSession_ptr = std::shared_ptr<SolverSession>;
+	  
 	  class State : public MiniMC::CPA::State
       {
 	  public:
-	State (const MiniMC::Util::SSAMap& map, const MiniMC::Util::SSAMap& gmap, const SMTLib::Context_ptr& context, const SMTLib::Term_ptr& path) : context(context),map(map),gmap(gmap),pathformula(path) {}
+	State (const MiniMC::Util::SSAMap& map, const MiniMC::Util::SSAMap& gmap, const SMTLib::Context_ptr& context, const SMTLib::Term_ptr& path, const SolverSession_ptr& session = nullptr) : context(context),map(map),gmap(gmap),pathformula(path),
+	  session(session ? session : std::make_shared<SolverSession> (context)),
+	  segment(std::make_shared<PathSegment> (PathSegment{nullptr,{path},0})) {}
 		State (const State& oth) = default;
 		virtual std::ostream& output (std::ostream& os) const {return os << map << "\nPathformula:" << *pathformula;}
 		MiniMC::Hash::hash_t hash (MiniMC::Hash::seed_t seed = 0) const override {return reinterpret_cast<MiniMC::Hash::hash_t> (this);}
@@ -37,6 +115,19 @@ namespace MiniMC {
 		
 	        auto& getPathFormula () {return pathformula;}
 		const auto& getPathFormula () const {return pathformula;}
+
+		auto& getSession () const {return session;}
+		auto& getPathSegment () const {return segment;}
+
+		/**
+		 * Set the path formula to \p path, which extends the current
+		 * one by \p conjuncts.
+		 */
+		void extendPath (const SMTLib::Term_ptr& path, std::vector<SMTLib::Term_ptr>&& conjuncts) {
+		  pathformula = path;
+		  if (conjuncts.size ())
+			segment = std::make_shared<PathSegment> (PathSegment{segment,std::move(conjuncts),segment->depth+1});
+		}
 		
 		const Concretizer_ptr getConcretizer () const override;
 		
@@ -48,27 +139,16 @@ namespace MiniMC {
 	        
 	        Heap heap;
 	        SMTLib::Term_ptr pathformula;
+		SolverSession_ptr session;
+		PathSegment_ptr segment;
 	  };
 
 	  class Concretizer : public MiniMC::CPA::Concretizer {
 	  public:
-		Concretizer (std::shared_ptr<const State> state) : state(state),
-															solver(state->getContext()->makeSolver())
-																				
-		{
-		  solver->assert_formula (state->getPathFormula ());
-		}
+		Concretizer (std::shared_ptr<const State> state) : state(state) {}
 		
 		virtual Feasibility isFeasible () const {
-		  MiniMC::Support::getMessager ().message ("Running SMT Solver");
-		  switch (solver->check_sat ()) {
-		  case SMTLib::Result::Satis:
-			return Feasibility::Feasible;
-		  case SMTLib::Result::NSatis:
-			return Feasibility::Infeasible;
-		  default:
-			return Feasibility::Unknown;
-		  }
+		  return state->getSession ()->check (state->getPathSegment ());
 		}
 
 		virtual std::ostream&  evaluate_str (proc_id id, const MiniMC::Model::Variable_ptr& var,std::ostream& os) {
@@ -77,7 +157,6 @@ namespace MiniMC {
 		
 	  private:
 		const std::shared_ptr<const State> state;
-		SMTLib::Solver_ptr  solver;
 	    Heap heap;
 	  };
 
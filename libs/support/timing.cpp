@@ -2,6 +2,8 @@
 #include "support/timing.hpp"
 #include <cassert>
 #include <chrono>
+#include <ctime>
+#include <iomanip>
 #include <string>
 #include <unordered_map>
 
@@ -12,8 +14,7 @@ namespace MiniMC {
     using duration_t = clock_t::duration;
 
     struct Timer::inner_t {
-      //elapsed_t total = {.seconds = 0, .milliseconds = 0};
-      duration_t duration;
+      duration_t duration{0};
       time_t time_started = clock_t::now();
       bool started = false;
       std::string name;
@@ -36,7 +37,7 @@ namespace MiniMC {
 
     void Timer::stopTimer() {
       assert(_inner->started);
-      auto duration = _inner->duration + (clock_t::now() - _inner->time_started);
+      _inner->duration += clock_t::now() - _inner->time_started;
       _inner->started = false;
     }
 
@@ -51,11 +52,160 @@ namespace MiniMC {
 
     Timer& Timer::getTimer(const std::string& name) {
       static std::unordered_map<std::string, std::unique_ptr<Timer>> timers;
+      static std::mutex mutex;
+      std::lock_guard lock(mutex);
       if (!timers.count(name)) {
         timers.insert(std::make_pair(name, std::make_unique<Timer>(name)));
       }
       return *timers.at(name);
     }
 
+    namespace {
+      std::chrono::nanoseconds threadCPUTime() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+          return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#endif
+        return std::chrono::nanoseconds(0);
+      }
+
+      double milliseconds(std::chrono::nanoseconds ns) {
+        return std::chrono::duration<double, std::milli>(ns).count();
+      }
+
+      std::string quote(const std::string& str) {
+        std::string res = "\"";
+        for (char c : str) {
+          if (c == '"' || c == '\\')
+            res += '\\';
+          res += c;
+        }
+        return res + "\"";
+      }
+    } // namespace
+
+    struct TraceEvent {
+      std::string name;
+      std::chrono::nanoseconds start;
+      std::chrono::nanoseconds duration;
+    };
+
+    struct Profiler::ThreadData {
+      std::size_t id;
+      std::string path;
+      std::vector<std::size_t> parents; /**< Length of path outside each running Phase */
+      std::map<std::string, PhaseStats> phases;
+      std::vector<TraceEvent> events;
+    };
+
+    Profiler::Profiler() : epoch(clock_t::now()) {}
+
+    Profiler& Profiler::get() {
+      static Profiler profiler;
+      return profiler;
+    }
+
+    void Profiler::enable(bool trace) {
+      tracing = trace;
+      epoch = clock_t::now();
+      enabled = true;
+    }
+
+    Profiler::ThreadData& Profiler::threadData() {
+      thread_local ThreadData* data = nullptr;
+      if (!data) {
+        std::lock_guard lock(mutex);
+        threads.push_back(std::make_unique<ThreadData>());
+        data = threads.back().get();
+        data->id = threads.size() - 1;
+      }
+      return *data;
+    }
+
+    std::map<std::string, PhaseStats> Profiler::getPhases() const {
+      std::lock_guard lock(mutex);
+      std::map<std::string, PhaseStats> res;
+      for (auto& thread : threads)
+        for (auto& [path, stats] : thread->phases)
+          res[path] += stats;
+      return res;
+    }
+
+    void Profiler::writeJSON(std::ostream& os) const {
+      auto phases = getPhases();
+      std::lock_guard lock(mutex);
+      os << std::fixed << std::setprecision(3);
+      os << "{\n  \"phases\": [";
+      bool firstPhase = true;
+      for (auto& [path, stats] : phases) {
+        os << (firstPhase ? "" : ",") << "\n    {\"phase\": " << quote(path)
+           << ", \"calls\": " << stats.calls
+           << ", \"wall_ms\": " << milliseconds(stats.wall)
+           << ", \"cpu_ms\": " << milliseconds(stats.cpu)
+           << ", \"threads\": [";
+        bool firstThread = true;
+        for (auto& thread : threads) {
+          auto it = thread->phases.find(path);
+          if (it == thread->phases.end())
+            continue;
+          os << (firstThread ? "" : ", ") << "{\"thread\": " << thread->id
+             << ", \"calls\": " << it->second.calls
+             << ", \"wall_ms\": " << milliseconds(it->second.wall)
+             << ", \"cpu_ms\": " << milliseconds(it->second.cpu) << "}";
+          firstThread = false;
+        }
+        os << "]}";
+        firstPhase = false;
+      }
+      os << "\n  ]\n}\n";
+    }
+
+    void Profiler::writeTrace(std::ostream& os) const {
+      std::lock_guard lock(mutex);
+      os << std::fixed << std::setprecision(3);
+      os << "{\"traceEvents\": [";
+      bool first = true;
+      for (auto& thread : threads) {
+        for (auto& event : thread->events) {
+          os << (first ? "" : ",") << "\n  {\"name\": " << quote(event.name)
+             << ", \"ph\": \"X\", \"pid\": 0, \"tid\": " << thread->id
+             << ", \"ts\": " << std::chrono::duration<double, std::micro>(event.start).count()
+             << ", \"dur\": " << std::chrono::duration<double, std::micro>(event.duration).count() << "}";
+          first = false;
+        }
+      }
+      os << "\n]}\n";
+    }
+
+    void Phase::start(const std::string& name) {
+      data = &Profiler::get().threadData();
+      data->parents.push_back(data->path.size());
+      if (data->path.size())
+        data->path += '/';
+      data->path += name;
+      cpuStart = threadCPUTime();
+      wallStart = clock_t::now();
+    }
+
+    void Phase::stop() {
+      auto wallEnd = clock_t::now();
+      auto cpu = threadCPUTime() - cpuStart;
+      auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(wallEnd - wallStart);
+      auto& stats = data->phases[data->path];
+      stats.calls++;
+      stats.wall += wall;
+      stats.cpu += cpu;
+
+      auto parent = data->parents.back();
+      data->parents.pop_back();
+      auto& profiler = Profiler::get();
+      if (profiler.isTracing())
+        data->events.push_back({data->path.substr(parent ? parent + 1 : 0),
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(wallStart - profiler.epoch),
+                                wall});
+      data->path.erase(parent);
+    }
+
   } // namespace Support
 } // namespace MiniMC
@@ -0,0 +1,123 @@
+#include "algorithms/successorgen.hpp"
+#include "cpa/compound.hpp"
+#include "cpa/concrete.hpp"
+#include "cpa/location.hpp"
+#include "programs.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+  using MiniMC::Tests::LocationConcrete;
+
+  /**
+   * Concrete::Transferer::doTransfer on an edge of range(0)
+   * instructions in a frame of range(1) variables
+   */
+  void BM_ConcreteTransfer (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (1,1,state.range (0),state.range (1));
+	MiniMC::CPA::Concrete::CPA cpa;
+	auto transfer = cpa.makeTransfer ();
+	auto init = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	auto& edge = prgm.edges[0];
+	for (auto _ : state)
+	  benchmark::DoNotOptimize (transfer->doTransfer (init,edge,0));
+	state.SetItemsProcessed (state.iterations ());
+	state.counters["instructions/s"] = benchmark::Counter (state.iterations () * state.range (0),benchmark::Counter::kIsRate);
+  }
+
+  /**
+   * Concrete::Transferer::doTransfer along a path: each iteration
+   * executes the range(0) instructions of the edge on the previous
+   * successor
+   */
+  void BM_ConcreteTransferPath (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (1,1,state.range (0));
+	MiniMC::CPA::Concrete::CPA cpa;
+	auto transfer = cpa.makeTransfer ();
+	auto cur = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	for (auto _ : state) {
+	  cur = transfer->doTransfer (cur,prgm.edges[0],0);
+	  benchmark::DoNotOptimize (cur);
+	}
+	state.SetItemsProcessed (state.iterations ());
+	state.counters["instructions/s"] = benchmark::Counter (state.iterations () * state.range (0),benchmark::Counter::kIsRate);
+  }
+
+  /**
+   * serializeState followed by deserializeState of a Location and
+   * Concrete State with range(0) variables per process and a heap
+   * object of range(1) bytes
+   */
+  void BM_SerializeRoundtrip (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (2,1,1,state.range (0),state.range (1));
+	LocationConcrete cpa;
+	auto query = cpa.makeQuery ();
+	auto init = query->makeInitialState (*prgm.prgm);
+	std::size_t bytes = 0;
+	for (auto _ : state) {
+	  auto data = MiniMC::CPA::serializeState (*init);
+	  bytes = data.size ();
+	  benchmark::DoNotOptimize (MiniMC::CPA::deserializeState (*query,*prgm.prgm,data.data (),data.size ()));
+	}
+	state.SetItemsProcessed (state.iterations ());
+	state.counters["bytes/state"] = bytes;
+  }
+
+  /**
+   * State::hash of a concrete State with range(0) variables per
+   * process and a heap object of range(1) bytes. The hash is
+   * recomputed on every call by passing a seed.
+   */
+  void BM_ConcreteHash (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (2,0,0,state.range (0),state.range (1));
+	MiniMC::CPA::Concrete::CPA cpa;
+	auto init = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	for (auto _ : state)
+	  benchmark::DoNotOptimize (init->hash (1));
+	state.SetItemsProcessed (state.iterations ());
+  }
+
+  /**
+   * State::hash of a fresh successor, whose written frame has to be
+   * hashed again
+   */
+  void BM_ConcreteHashAfterTransfer (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (2,1,1,state.range (0),state.range (1));
+	MiniMC::CPA::Concrete::CPA cpa;
+	auto transfer = cpa.makeTransfer ();
+	auto init = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	for (auto _ : state) {
+	  auto succ = transfer->doTransfer (init,prgm.edges[0],0);
+	  benchmark::DoNotOptimize (succ->hash ());
+	}
+	state.SetItemsProcessed (state.iterations ());
+  }
+
+  /**
+   * Enumerating all successors with the Generator for range(0)
+   * processes with range(1) enabled edges each
+   */
+  void BM_Generator (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (state.range (0),state.range (1),1,4);
+	LocationConcrete cpa;
+	auto transfer = cpa.makeTransfer ();
+	auto init = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	MiniMC::Algorithms::Generator generator (transfer);
+	std::size_t successors = 0;
+	for (auto _ : state) {
+	  auto [it,end] = generator.generate (init);
+	  for (; it != end; ++it) {
+		benchmark::DoNotOptimize (it->state);
+		successors++;
+	  }
+	}
+	state.SetItemsProcessed (successors);
+  }
+}
+
+BENCHMARK (BM_ConcreteTransfer)->ArgsProduct ({{1,8,64},{4,64}});
+BENCHMARK (BM_ConcreteTransferPath)->Arg (1)->Arg (8)->Arg (64);
+BENCHMARK (BM_SerializeRoundtrip)->ArgsProduct ({{4,64},{0,256,65536}});
+BENCHMARK (BM_ConcreteHash)->ArgsProduct ({{4,64,1024},{0,256,65536}});
+BENCHMARK (BM_ConcreteHashAfterTransfer)->ArgsProduct ({{4,64,1024},{0,65536}});
+BENCHMARK (BM_Generator)->ArgsProduct ({{1,4,16},{1,8}});
@@ -0,0 +1,43 @@
+#ifdef MINIMC_SYMBOLIC
+#include "cpa/pathformula.hpp"
+#include "programs.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+  /**
+   * Term construction of PathFormula::Transferer::doTransfer on an
+   * edge of range(0) instructions. No solver is called.
+   */
+  void BM_PathFormulaTransfer (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (1,1,state.range (0));
+	MiniMC::CPA::PathFormula::CPA cpa;
+	auto transfer = cpa.makeTransfer ();
+	auto init = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	for (auto _ : state)
+	  benchmark::DoNotOptimize (transfer->doTransfer (init,prgm.edges[0],0));
+	state.SetItemsProcessed (state.iterations ());
+	state.counters["instructions/s"] = benchmark::Counter (state.iterations () * state.range (0),benchmark::Counter::kIsRate);
+  }
+
+  /**
+   * Building a path formula along range(0) consecutive transfers
+   */
+  void BM_PathFormulaPath (benchmark::State& state) {
+	MiniMC::Bench::Program prgm (1,1,4);
+	MiniMC::CPA::PathFormula::CPA cpa;
+	auto transfer = cpa.makeTransfer ();
+	auto init = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+	for (auto _ : state) {
+	  auto cur = init;
+	  for (std::int64_t i = 0; i < state.range (0); ++i)
+		cur = transfer->doTransfer (cur,prgm.edges[0],0);
+	  benchmark::DoNotOptimize (cur);
+	}
+	state.SetItemsProcessed (state.iterations () * state.range (0));
+  }
+}
+
+BENCHMARK (BM_PathFormulaTransfer)->Arg (1)->Arg (8)->Arg (64);
+BENCHMARK (BM_PathFormulaPath)->Arg (16)->Arg (256);
+#endif
@@ -0,0 +1,49 @@
+#ifndef _BENCH_PROGRAMS__
+#define _BENCH_PROGRAMS__
+
+#include "programbuilder.hpp"
+
+#include <string>
+#include <vector>
+
+namespace MiniMC {
+  namespace Bench {
+
+	/**
+	 * Program with \p processes entry points running "main". main has
+	 * \p frame 64 bit local variables x0, x1, ... and a single
+	 * location with \p edges self loops; each loop adds its own
+	 * constant to x0 in \p length instructions. The globals are a
+	 * counter g and a pointer p to a heap object of \p heap bytes.
+	 */
+	struct Program : public MiniMC::Tests::ProgramBuilder {
+	  Program (std::size_t processes, std::size_t edges, std::size_t length, std::size_t frame = 1, std::size_t heap = 0) {
+		auto& cfac = prgm->getConstantFactory ();
+		g = global ("g",int64);
+		p = global ("p",prgm->getTypeFactory ()->makePointerType ());
+		auto main = function ("main");
+		for (std::size_t i = 0; i < std::max<std::size_t> (frame,1); ++i)
+		  locals.push_back (main.local ("x" + std::to_string (i),int64));
+
+		auto loc = main.location ("loop");
+		for (std::size_t e = 0; e < edges; ++e)
+		  this->edges.push_back (main.edge (loc,loc,std::vector<MiniMC::Model::Instruction> (length,add (locals[0],locals[0],e + 1))));
+		start (main,processes);
+
+		if (heap) {
+		  std::vector<MiniMC::Model::Instruction> init;
+		  init.push_back (MiniMC::Model::InstBuilder<MiniMC::Model::InstructionCode::Alloca> {}.setRes (p).setSize (cfac->makeIntegerConstant (heap,int64)).BuildInstruction ());
+		  prgm->setInitialiser (MiniMC::Model::InstructionStream (init));
+		}
+	  }
+
+	  MiniMC::Model::Variable_ptr g;
+	  MiniMC::Model::Variable_ptr p;
+	  std::vector<MiniMC::Model::Variable_ptr> locals;
+	  std::vector<MiniMC::Model::Edge_ptr> edges;
+	};
+
+  }
+}
+
+#endif
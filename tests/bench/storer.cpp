@@ -0,0 +1,68 @@
+#include "cpa/interface.hpp"
+#include "hash/hashing.hpp"
+#include "intstate.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+  using MiniMC::Tests::IntJoiner;
+  using MiniMC::Tests::IntState;
+
+  /**
+   * Minimal State with a well spread hash, so the benchmarks measure
+   * the store rather than hashing or comparing States
+   */
+  MiniMC::CPA::State_ptr makeState (MiniMC::uint64_t val) {
+	return std::make_shared<IntState> (val,MiniMC::Hash::Hash (&val,1,0));
+  }
+
+  std::vector<MiniMC::CPA::State_ptr> makeStates (std::size_t count) {
+	std::vector<MiniMC::CPA::State_ptr> res;
+	res.reserve (count);
+	for (std::size_t i = 0; i < count; ++i)
+	  res.push_back (makeState (i));
+	return res;
+  }
+
+  /**
+   * Filling a HashStorer with range(0) States, checking each before
+   * saving it as the searches do
+   */
+  void BM_StorerInsert (benchmark::State& state) {
+	auto states = makeStates (state.range (0));
+	auto joiner = std::make_shared<IntJoiner> ();
+	for (auto _ : state) {
+	  MiniMC::CPA::HashStorer store (joiner);
+	  for (auto& s : states) {
+		if (!store.isCoveredByStore (s))
+		  store.saveState (s);
+	  }
+	  benchmark::DoNotOptimize (store);
+	}
+	state.SetItemsProcessed (state.iterations () * state.range (0));
+  }
+
+  /**
+   * Looking up States in a HashStorer of range(0) States. Half of the
+   * lookups hit.
+   */
+  void BM_StorerLookup (benchmark::State& state) {
+	auto count = state.range (0);
+	MiniMC::CPA::HashStorer store (std::make_shared<IntJoiner> ());
+	for (auto& s : makeStates (count))
+	  store.saveState (s);
+	std::vector<MiniMC::CPA::State_ptr> probes;
+	std::size_t nbProbes = std::min<std::size_t> (count,1 << 16);
+	for (std::size_t k = 0; k < nbProbes; ++k)
+	  probes.push_back (makeState (2 * count * k / nbProbes));
+	std::size_t i = 0;
+	for (auto _ : state) {
+	  benchmark::DoNotOptimize (store.isCoveredByStore (probes[i]));
+	  i = (i + 1) % probes.size ();
+	}
+	state.SetItemsProcessed (state.iterations ());
+  }
+}
+
+BENCHMARK (BM_StorerInsert)->RangeMultiplier (10)->Range (1000,10000000)->Unit (benchmark::kMillisecond);
+BENCHMARK (BM_StorerLookup)->RangeMultiplier (10)->Range (1000,10000000);
@@ -0,0 +1,107 @@
+#include "instructionimpl.hpp"
+#include "util/vm.hpp"
+#include "programs.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+  using MiniMC::Model::InstructionCode;
+
+  /**
+   * Frame of a single process with operands for each benchmarked
+   * opcode. The heap holds an 8 byte object that p points to.
+   */
+  struct Frame {
+	Frame () : prgm(1,0,0) {
+	  auto& tfac = prgm.prgm->getTypeFactory ();
+	  auto stack = prgm.prgm->makeVariableStack ("vm");
+	  x = stack->addVariable ("x",prgm.int64);
+	  y = stack->addVariable ("y",prgm.int64);
+	  b = stack->addVariable ("b",tfac->makeBoolType ());
+	  n = stack->addVariable ("n",tfac->makeIntegerType (32));
+
+	  MiniMC::CPA::Concrete::VariableLookup vars (stack->getTotalVariables ());
+	  for (auto& v : stack->getVariables ())
+		vars.set (v,MiniMC::Util::Array (v->getType ()->getSize ()));
+	  MiniMC::Util::Array seven (8);
+	  seven.set (0,MiniMC::uint64_t{7});
+	  vars.set (y,seven);
+
+	  MiniMC::CPA::Concrete::Heap mem;
+	  MiniMC::Util::Array pointer (sizeof (MiniMC::pointer_t));
+	  pointer.set (0,mem.allocate (8));
+	  MiniMC::CPA::Concrete::VariableLookup glob (prgm.prgm->getGlobals ()->getTotalVariables ());
+	  for (auto& v : prgm.prgm->getGlobals ()->getVariables ())
+		glob.set (v,MiniMC::Util::Array (v->getType ()->getSize ()));
+	  glob.set (prgm.p,pointer);
+
+	  globals = std::make_unique<MiniMC::CPA::Concrete::SharedVariableLookup> (glob);
+	  locals = std::make_unique<MiniMC::CPA::Concrete::SharedVariableLookup> (vars);
+	  heap = std::make_unique<MiniMC::CPA::Concrete::SharedHeap> (mem);
+	}
+
+	template<InstructionCode opc>
+	MiniMC::Model::Instruction make () {
+	  if constexpr (MiniMC::Model::InstructionData<opc>::isTAC)
+		return MiniMC::Model::InstBuilder<opc> {}.setRes (x).setLeft (x).setRight (y).BuildInstruction ();
+	  else if constexpr (MiniMC::Model::InstructionData<opc>::isComparison)
+		return MiniMC::Model::InstBuilder<opc> {}.setRes (b).setLeft (x).setRight (y).BuildInstruction ();
+	  else if constexpr (MiniMC::Model::InstructionData<opc>::isCast)
+		return MiniMC::Model::InstBuilder<opc> {}.setRes (x).setCastee (n).BuildInstruction ();
+	  else if constexpr (opc == InstructionCode::Assign)
+		return MiniMC::Model::InstBuilder<opc> {}.setResult (x).setValue (y).BuildInstruction ();
+	  else if constexpr (opc == InstructionCode::Store)
+		return MiniMC::Model::InstBuilder<opc> {}.setValue (x).setAddress (prgm.p).BuildInstruction ();
+	  else if constexpr (opc == InstructionCode::Load)
+		return MiniMC::Model::InstBuilder<opc> {}.setRes (x).setAddress (prgm.p).BuildInstruction ();
+	}
+
+	MiniMC::CPA::Concrete::VMData data () {
+	  return MiniMC::CPA::Concrete::VMData {
+		.readFrom = {.global = globals.get (), .local = locals.get (), .heap = heap.get ()},
+		.writeTo = {.global = globals.get (), .local = locals.get (), .heap = heap.get ()}};
+	}
+
+	MiniMC::Bench::Program prgm;
+	MiniMC::Model::Variable_ptr x;
+	MiniMC::Model::Variable_ptr y;
+	MiniMC::Model::Variable_ptr b;
+	MiniMC::Model::Variable_ptr n;
+	std::unique_ptr<MiniMC::CPA::Concrete::SharedVariableLookup> globals;
+	std::unique_ptr<MiniMC::CPA::Concrete::SharedVariableLookup> locals;
+	std::unique_ptr<MiniMC::CPA::Concrete::SharedHeap> heap;
+  };
+
+  /**
+   * Executes a stream of 64 instructions with opcode opc through
+   * runVM, as Concrete::Transferer does for an edge
+   */
+  template<InstructionCode opc>
+  void BM_ConcreteVM (benchmark::State& state) {
+	const std::size_t length = 64;
+	Frame frame;
+	std::vector<MiniMC::Model::Instruction> instr (length,frame.make<opc> ());
+	MiniMC::Model::InstructionStream source (instr);
+	MiniMC::CPA::Concrete::DecodedStream stream (source);
+	auto data = frame.data ();
+	for (auto _ : state) {
+	  MiniMC::Util::runVM<decltype (stream.begin ()),MiniMC::CPA::Concrete::VMData,MiniMC::CPA::Concrete::ExecuteInstruction> (stream.begin (),stream.end (),data);
+	  benchmark::ClobberMemory ();
+	}
+	state.SetItemsProcessed (state.iterations () * length);
+  }
+}
+
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Add);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Sub);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Mul);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::UDiv);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Shl);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Xor);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::ICMP_SLT);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::ICMP_EQ);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::ZExt);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::SExt);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Assign);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Store);
+BENCHMARK_TEMPLATE (BM_ConcreteVM,InstructionCode::Load);
@@ -0,0 +1,109 @@
+#include "algorithms/simulationmanager.hpp"
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+using MiniMC::Tests::LocationConcrete;
+
+MiniMC::Algorithms::BudgetExceeded searchWithBudget (std::size_t threads, const MiniMC::Algorithms::Budget& budget, std::size_t& waiting) {
+  MiniMC::Tests::Counter counter;
+  LocationConcrete cpa;
+  MiniMC::Algorithms::SimulationManager manager ({.storer = cpa.makeStore (),
+												  .joiner = cpa.makeJoin (),
+												  .transfer = cpa.makeTransfer (),
+												  .threads = threads,
+												  .budget = std::make_shared<MiniMC::Algorithms::BudgetGuard> (budget)});
+  manager.insert (cpa.makeQuery ()->makeInitialState (*counter.prgm));
+  EXPECT_EQ (manager.reachabilitySearch ({}),nullptr);
+  waiting = manager.getWSize ();
+  EXPECT_GE (manager.getPSize (),budget.states);
+  return manager.budgetExceeded ();
+}
+
+TEST(budget, unlimitedNeverExceeds) {
+  MiniMC::Algorithms::BudgetGuard guard ({});
+  EXPECT_FALSE (guard.checkStates (1000000));
+  EXPECT_FALSE (guard.checkResources ());
+  EXPECT_EQ (guard.exceeded (),MiniMC::Algorithms::BudgetExceeded::None);
+}
+
+TEST(budget, exceededLimitIsKept) {
+  MiniMC::Algorithms::BudgetGuard guard ({.states = 10});
+  EXPECT_FALSE (guard.checkStates (9));
+  EXPECT_TRUE (guard.checkStates (10));
+  EXPECT_TRUE (guard.checkStates (0));
+  EXPECT_EQ (guard.exceeded (),MiniMC::Algorithms::BudgetExceeded::States);
+}
+
+TEST(budget, sequentialSearchStopsAtStateBudget) {
+  std::size_t waiting = 0;
+  EXPECT_EQ (searchWithBudget (1,{.states = 100},waiting),MiniMC::Algorithms::BudgetExceeded::States);
+  EXPECT_GT (waiting,0);
+}
+
+TEST(budget, parallelSearchStopsAtStateBudget) {
+  std::size_t waiting = 0;
+  EXPECT_EQ (searchWithBudget (2,{.states = 1000},waiting),MiniMC::Algorithms::BudgetExceeded::States);
+  EXPECT_GT (waiting,0);
+}
+
+TEST(budget, searchStopsAtTimeBudget) {
+  std::size_t waiting = 0;
+  EXPECT_EQ (searchWithBudget (1,{.time = std::chrono::seconds (1)},waiting),MiniMC::Algorithms::BudgetExceeded::Time);
+  EXPECT_GT (waiting,0);
+}
+
+/* A single process branching \p fanout ways from every location down to depth \p depth */
+struct Tree : public MiniMC::Tests::ProgramBuilder {
+  Tree (std::size_t fanout, std::size_t depth) {
+	auto main = function ("main");
+	std::vector<MiniMC::Model::Location_ptr> layer {main.location ("root")};
+	for (std::size_t d = 0; d < depth; ++d) {
+	  std::vector<MiniMC::Model::Location_ptr> next;
+	  for (auto& loc : layer) {
+		for (std::size_t i = 0; i < fanout; ++i) {
+		  next.push_back (main.location (loc->getInfo ().getName () + "." + std::to_string (i)));
+		  main.edge (loc,next.back ());
+		}
+	  }
+	  layer = std::move (next);
+	}
+	start (main);
+  }
+};
+
+std::size_t storedStates (MiniMC::Algorithms::SimulationManager& manager) {
+  return manager.stored_end ()-manager.stored_begin ();
+}
+
+TEST(budget, parallelCheckpointResumesToFullStateSpace) {
+  Tree tree (4,4);
+  LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto makeManager = [&](const MiniMC::Algorithms::Budget& budget) {
+	return MiniMC::Algorithms::SimulationManager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												   .storer = cpa.makeStore (),
+												   .joiner = cpa.makeJoin (),
+												   .transfer = cpa.makeTransfer (),
+												   .threads = 2,
+												   .budget = std::make_shared<MiniMC::Algorithms::BudgetGuard> (budget)});
+  };
+
+  auto full = makeManager ({});
+  full.insert (query->makeInitialState (*tree.prgm));
+  EXPECT_EQ (full.reachabilitySearch ({}),nullptr);
+  EXPECT_EQ (storedStates (full),1+4+16+64+256);
+
+  for (std::size_t states : {2,10,50,200}) {
+	auto budgeted = makeManager ({.states = states});
+	budgeted.insert (query->makeInitialState (*tree.prgm));
+	EXPECT_EQ (budgeted.reachabilitySearch ({}),nullptr);
+	EXPECT_EQ (budgeted.budgetExceeded (),MiniMC::Algorithms::BudgetExceeded::States);
+	auto data = budgeted.checkpoint ();
+
+	auto resumed = makeManager ({});
+	MiniMC::Support::Reader reader (data);
+	resumed.restore (reader,*query,*tree.prgm);
+	EXPECT_EQ (resumed.reachabilitySearch ({}),nullptr);
+	EXPECT_EQ (storedStates (resumed),storedStates (full)) << "budget " << states;
+  }
+}
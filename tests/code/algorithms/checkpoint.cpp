@@ -0,0 +1,97 @@
+#include "algorithms/simulationmanager.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+#include "programbuilder.hpp"
+#include <algorithm>
+
+using MiniMC::Tests::IntState;
+using MiniMC::Tests::IntJoiner;
+using MiniMC::Tests::IntQuery;
+
+MiniMC::Model::Program program (std::make_shared<MiniMC::Model::TypeFactory64> (),
+								std::make_shared<MiniMC::Model::ConstantFactory64> ());
+
+MiniMC::Algorithms::SimManagerOptions options () {
+  auto joiner = std::make_shared<IntJoiner> ();
+  return {.storage = [](const MiniMC::CPA::State_ptr& s) {return static_cast<const IntState&> (*s).val % 2 == 0;},
+		  .storer = std::make_shared<MiniMC::CPA::HashStorer> (joiner),
+		  .joiner = joiner,
+		  .transfer = std::make_shared<MiniMC::CPA::Transferer> (),
+		  .order = MiniMC::Algorithms::SearchOrder::BreadthFirst};
+}
+
+std::vector<int> waiting (const MiniMC::Algorithms::SimulationManager& manager) {
+  std::vector<int> res;
+  manager.for_each_waiting ([&res](const MiniMC::CPA::State_ptr& s) {res.push_back (static_cast<const IntState&> (*s).val);});
+  return res;
+}
+
+TEST(checkpoint, restoreWaitingAndStored) {
+  MiniMC::Algorithms::SimulationManager manager (options ());
+  for (int i = 0; i < 5; ++i)
+	manager.insert (std::make_shared<IntState> (i));
+  auto data = manager.checkpoint ();
+
+  MiniMC::Algorithms::SimulationManager restored (options ());
+  IntQuery query;
+  MiniMC::Support::Reader reader (data);
+  restored.restore (reader,query,program);
+  EXPECT_EQ (restored.getPSize (),manager.getPSize ());
+  EXPECT_EQ (waiting (restored),(std::vector<int>{0,1,2,3,4}));
+  EXPECT_EQ (restored.stored_end ()-restored.stored_begin (),3);
+
+  // Waiting States that were stored are shared with the store again
+  auto stored = *restored.stored_begin ();
+  bool shared = false;
+  restored.for_each_waiting ([&](const MiniMC::CPA::State_ptr& s) {shared |= s == stored;});
+  EXPECT_TRUE (shared);
+}
+
+TEST(checkpoint, fileRoundtrip) {
+  auto file = std::filesystem::temp_directory_path () / "minimc-checkpoint-test";
+  MiniMC::Algorithms::CheckpointHeader header {.program = MiniMC::Algorithms::programHash (program),.setup = 17,.search = 23};
+  std::vector<MiniMC::uint8_t> body {1,2,3};
+  {
+	MiniMC::Algorithms::Checkpointer checkpointer (file,header,std::chrono::seconds (0));
+	EXPECT_TRUE (checkpointer.due ());
+	checkpointer.save (std::vector<MiniMC::uint8_t> (body));
+	checkpointer.wait ();
+	EXPECT_EQ (checkpointer.getWritten (),1);
+  }
+  auto ckpt = MiniMC::Algorithms::Checkpoint::read (file);
+  EXPECT_EQ (ckpt.header,header);
+  auto reader = ckpt.body ();
+  EXPECT_EQ (reader.remaining (),body.size ());
+  EXPECT_TRUE (std::equal (body.begin (),body.end (),reader.bytes (body.size ())));
+  std::filesystem::remove (file);
+}
+
+TEST(checkpoint, rejectsOtherFiles) {
+  auto file = std::filesystem::temp_directory_path () / "minimc-checkpoint-garbage";
+  std::ofstream (file) << "not a checkpoint";
+  EXPECT_THROW (MiniMC::Algorithms::Checkpoint::read (file),MiniMC::Support::SerializationError);
+  std::filesystem::remove (file);
+}
+
+TEST(checkpoint, setupHashDependsOnOptions) {
+  MiniMC::Algorithms::SetupOptions sopt;
+  auto before = MiniMC::Algorithms::setupHash (sopt);
+  sopt.unrollLoops = 3;
+  EXPECT_NE (MiniMC::Algorithms::setupHash (sopt),before);
+}
+
+TEST(checkpoint, searchHashDependsOnOptions) {
+  MiniMC::Tests::LocationConcrete concrete;
+  MiniMC::CPA::Location::CPA location;
+  auto before = MiniMC::Algorithms::searchHash (concrete,false,false);
+  EXPECT_EQ (MiniMC::Algorithms::searchHash (concrete,false,false),before);
+  EXPECT_NE (MiniMC::Algorithms::searchHash (location,false,false),before);
+  EXPECT_NE (MiniMC::Algorithms::searchHash (concrete,true,false),before);
+  EXPECT_NE (MiniMC::Algorithms::searchHash (concrete,false,true),before);
+
+  auto cpa = std::make_shared<MiniMC::Tests::LocationConcrete> ();
+  MiniMC::CPA::ApproximateStorageCPA exact (cpa,MiniMC::CPA::StorageMode::Exact,1024);
+  MiniMC::CPA::ApproximateStorageCPA collapse (cpa,MiniMC::CPA::StorageMode::Collapse,1024);
+  EXPECT_EQ (MiniMC::Algorithms::searchHash (exact,false,false),before);
+  EXPECT_NE (MiniMC::Algorithms::searchHash (collapse,false,false),before);
+}
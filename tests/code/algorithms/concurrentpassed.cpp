@@ -0,0 +1,42 @@
+#include "algorithms/workstealing.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+
+#include <atomic>
+#include <thread>
+
+using MiniMC::Tests::IntState;
+using MiniMC::Tests::IntJoiner;
+
+/* Hashes modulo 7, so distinct States collide */
+MiniMC::CPA::State_ptr make (int val) {
+  return std::make_shared<IntState> (val,val % 7);
+}
+
+TEST(concurrentpassed, insertOnce) {
+  MiniMC::Algorithms::ConcurrentPassed passed (std::make_shared<IntJoiner> (),4);
+  EXPECT_TRUE (passed.insert (make (1)));
+  EXPECT_FALSE (passed.insert (make (1)));
+  EXPECT_TRUE (passed.insert (make (8)));
+}
+
+TEST(concurrentpassed, threadsInsertEachStateOnce) {
+  MiniMC::Algorithms::ConcurrentPassed passed (std::make_shared<IntJoiner> (),4);
+  std::atomic<std::size_t> inserted = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+	threads.emplace_back ([&]() {
+	  for (int i = 0; i < 1000; ++i) {
+		if (passed.insert (make (i)))
+		  inserted++;
+	  }
+	});
+  }
+  for (auto& t : threads)
+	t.join ();
+  EXPECT_EQ (inserted,1000);
+
+  std::size_t stored = 0;
+  passed.for_each ([&](const MiniMC::CPA::State_ptr&) {stored++;});
+  EXPECT_EQ (stored,1000);
+}
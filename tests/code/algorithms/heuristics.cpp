@@ -0,0 +1,173 @@
+#include "algorithms/heuristics.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+#include "programbuilder.hpp"
+
+using MiniMC::Model::AttrType;
+using MiniMC::Model::Attributes;
+using MiniMC::Tests::IntState;
+
+/* f: start -> mid -> violated and start -> other, followed by a dead
+   end of deadEnd locations */
+struct Assertion : public MiniMC::Tests::ProgramBuilder {
+  Assertion (std::size_t deadEnd = 0) {
+	auto f = function ("f");
+	start = f.location ("start");
+	mid = f.location ("mid");
+	other = f.location ("other");
+	violated = f.location ("violated",static_cast<AttrType> (Attributes::AssertViolated));
+	toMid = f.edge (start,mid);
+	toViolated = f.edge (mid,violated);
+	toOther = f.edge (start,other);
+	auto prev = other;
+	for (std::size_t i = 0; i < deadEnd; ++i) {
+	  auto loc = f.location ("dead" + std::to_string (i));
+	  f.edge (prev,loc);
+	  prev = loc;
+	}
+	ProgramBuilder::start (f);
+  }
+
+  MiniMC::Model::Location_ptr start;
+  MiniMC::Model::Location_ptr mid;
+  MiniMC::Model::Location_ptr other;
+  MiniMC::Model::Location_ptr violated;
+  MiniMC::Model::Edge_ptr toMid;
+  MiniMC::Model::Edge_ptr toViolated;
+  MiniMC::Model::Edge_ptr toOther;
+};
+
+std::vector<int> popAll (MiniMC::Algorithms::SearchStrategy strategy, const MiniMC::Model::Program& prgm, const std::vector<int>& vals) {
+  auto setup = MiniMC::Algorithms::makeSearch (strategy,prgm);
+  MiniMC::Algorithms::WaitingList waiting (setup.order,setup.priority);
+  for (auto v : vals)
+	waiting.push (std::make_shared<IntState> (v));
+  std::vector<int> res;
+  while (waiting.size ())
+	res.push_back (static_cast<const IntState&> (*waiting.pop ()).val);
+  return res;
+}
+
+TEST(assertdistance, backwardBFS) {
+  Assertion prgm;
+  prgm.function ("g").location ("unrelated");
+  
+  MiniMC::Algorithms::AssertDistance dist (*prgm.prgm);
+  EXPECT_EQ (dist.distance (prgm.violated.get ()),0);
+  EXPECT_EQ (dist.distance (prgm.mid.get ()),1);
+  EXPECT_EQ (dist.distance (prgm.start.get ()),2);
+  EXPECT_EQ (dist.distance (prgm.other.get ()),MiniMC::Algorithms::AssertDistance::unreachable);
+}
+
+TEST(heuristics, depthAndBreadthFirst) {
+  Assertion prgm;
+  EXPECT_EQ (popAll (MiniMC::Algorithms::SearchStrategy::DepthFirst,*prgm.prgm,{1,2,3}),(std::vector<int>{3,2,1}));
+  EXPECT_EQ (popAll (MiniMC::Algorithms::SearchStrategy::BreadthFirst,*prgm.prgm,{1,2,3}),(std::vector<int>{1,2,3}));
+}
+
+TEST(heuristics, closestToAssertFirst) {
+  Assertion prgm;
+  MiniMC::Tests::LocationConcrete cpa;
+  auto transfer = cpa.makeTransfer ();
+  auto start = cpa.makeQuery ()->makeInitialState (*prgm.prgm);
+  auto mid = transfer->doTransfer (start,prgm.toMid,0);
+  auto other = transfer->doTransfer (start,prgm.toOther,0);
+  ASSERT_NE (mid,nullptr);
+  ASSERT_NE (other,nullptr);
+
+  auto setup = MiniMC::Algorithms::makeSearch (MiniMC::Algorithms::SearchStrategy::AssertDistance,*prgm.prgm);
+  MiniMC::Algorithms::WaitingList waiting (setup.order,setup.priority);
+  waiting.push (other);
+  waiting.push (start);
+  waiting.push (mid);
+  EXPECT_EQ (waiting.pop (),mid);
+  EXPECT_EQ (waiting.pop (),start);
+  EXPECT_EQ (waiting.pop (),other);
+}
+
+TEST(heuristics, randomOrderFollowsTheSeed) {
+  Assertion prgm;
+  std::vector<int> vals {0,1,2,3,4,5,6,7};
+  MiniMC::Support::setSeed (7);
+  MiniMC::Support::RandomNumber<>::selectStream (0);
+  auto first = popAll (MiniMC::Algorithms::SearchStrategy::Random,*prgm.prgm,vals);
+  MiniMC::Support::RandomNumber<>::selectStream (0);
+  EXPECT_EQ (popAll (MiniMC::Algorithms::SearchStrategy::Random,*prgm.prgm,vals),first);
+  EXPECT_NE (first,vals);
+  std::sort (first.begin (),first.end ());
+  EXPECT_EQ (first,vals);
+}
+
+/**
+ * @return number of States passed until the search finds the violated
+ * assert
+ */
+std::size_t passedUntilViolation (MiniMC::Algorithms::SearchStrategy strategy, const MiniMC::Model::Program& prgm) {
+  MiniMC::Tests::LocationConcrete cpa;
+  auto setup = MiniMC::Algorithms::makeSearch (strategy,prgm);
+  MiniMC::Algorithms::SimulationManager manager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												  .storer = cpa.makeStore (),
+												  .joiner = cpa.makeJoin (),
+												  .transfer = cpa.makeTransfer (),
+												  .order = setup.order,
+												  .priority = setup.priority});
+  manager.insert (cpa.makeQuery ()->makeInitialState (prgm));
+  auto found = manager.reachabilitySearch ({.goal = [](const MiniMC::CPA::State_ptr& s) {return s->assertViolated ();}});
+  EXPECT_NE (found,nullptr);
+  return manager.getPSize ();
+}
+
+TEST(heuristics, assertDistanceFindsViolationBeforeDepthFirst) {
+  Assertion prgm (20);
+  auto dfs = passedUntilViolation (MiniMC::Algorithms::SearchStrategy::DepthFirst,*prgm.prgm);
+  auto distance = passedUntilViolation (MiniMC::Algorithms::SearchStrategy::AssertDistance,*prgm.prgm);
+  EXPECT_GT (dfs,20);
+  EXPECT_LT (distance,dfs);
+  EXPECT_LE (distance,3);
+}
+
+MiniMC::Algorithms::RestartResult restartSearch (const MiniMC::Model::Program& prgm, const MiniMC::Algorithms::Restarts& restarts) {
+  MiniMC::Tests::LocationConcrete cpa;
+  auto setup = MiniMC::Algorithms::makeSearch (MiniMC::Algorithms::SearchStrategy::RandomRestart,prgm);
+  auto makeManager = [&]() {
+	return MiniMC::Algorithms::SimulationManager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												   .storer = cpa.makeStore (),
+												   .joiner = cpa.makeJoin (),
+												   .transfer = cpa.makeTransfer (),
+												   .order = setup.order,
+												   .priority = setup.priority});
+  };
+  return MiniMC::Algorithms::randomRestartSearch (makeManager,
+												  cpa.makeQuery ()->makeInitialState (prgm),
+												  {.goal = [](const MiniMC::CPA::State_ptr& s) {return s->assertViolated ();}},
+												  restarts,nullptr,nullptr);
+}
+
+TEST(randomrestart, restartsUntilTheBoundOnInfiniteStateSpace) {
+  MiniMC::Tests::Counter counter;
+  auto res = restartSearch (*counter.prgm,{.bound = 10, .count = 3});
+  EXPECT_EQ (res.found,nullptr);
+  EXPECT_FALSE (res.complete);
+  EXPECT_EQ (res.restarts,3);
+}
+
+TEST(randomrestart, findsViolation) {
+  Assertion prgm;
+  auto res = restartSearch (*prgm.prgm,{.bound = 10, .count = 3});
+  ASSERT_NE (res.found,nullptr);
+  EXPECT_TRUE (res.found->assertViolated ());
+  EXPECT_EQ (res.restarts,0);
+}
+
+TEST(randomrestart, completeWithinTheBound) {
+  MiniMC::Tests::ProgramBuilder builder;
+  auto main = builder.function ("main");
+  auto start = main.location ("start");
+  auto end = main.location ("end");
+  main.edge (start,end);
+  builder.start (main);
+  auto res = restartSearch (*builder.prgm,{.bound = 10, .count = 3});
+  EXPECT_EQ (res.found,nullptr);
+  EXPECT_TRUE (res.complete);
+  EXPECT_EQ (res.restarts,0);
+}
@@ -0,0 +1,120 @@
+#include "algorithms/por.hpp"
+#include "algorithms/simulationmanager.hpp"
+#include "algorithms/successorgen.hpp"
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+using MiniMC::Model::Instruction;
+using MiniMC::Model::InstructionCode;
+using MiniMC::Model::AttrType;
+using MiniMC::Model::Attributes;
+
+MiniMC::Model::Variable_ptr makeVar (const std::string& name, bool global) {
+  auto var = std::make_shared<MiniMC::Model::Variable> (name);
+  if (global)
+	var->setGlobal ();
+  return var;
+}
+
+TEST(partialorder, localArithmeticIsLocal) {
+  auto res = makeVar ("res",false);
+  auto l = makeVar ("l",false);
+  auto r = makeVar ("r",false);
+  EXPECT_TRUE (MiniMC::Algorithms::PartialOrderReduction::isLocal (Instruction (InstructionCode::Add,{res,l,r})));
+}
+
+TEST(partialorder, globalOperandIsNotLocal) {
+  auto res = makeVar ("res",false);
+  auto l = makeVar ("l",false);
+  auto g = makeVar ("g",true);
+  EXPECT_FALSE (MiniMC::Algorithms::PartialOrderReduction::isLocal (Instruction (InstructionCode::Add,{res,l,g})));
+  EXPECT_FALSE (MiniMC::Algorithms::PartialOrderReduction::isLocal (Instruction (InstructionCode::Assign,{g,l})));
+}
+
+TEST(partialorder, memoryAccessIsNotLocal) {
+  auto addr = makeVar ("addr",false);
+  auto val = makeVar ("val",false);
+  EXPECT_FALSE (MiniMC::Algorithms::PartialOrderReduction::isLocal (Instruction (InstructionCode::Store,{addr,val})));
+  EXPECT_FALSE (MiniMC::Algorithms::PartialOrderReduction::isLocal (Instruction (InstructionCode::Load,{val,addr})));
+}
+
+TEST(partialorder, reductionRatio) {
+  MiniMC::Model::Program prgm (std::make_shared<MiniMC::Model::TypeFactory64> (),
+							   std::make_shared<MiniMC::Model::ConstantFactory64> ());
+  MiniMC::Algorithms::PartialOrderReduction por (prgm);
+  EXPECT_EQ (por.getReductionRatio (),1);
+  por.record (1,4);
+  por.record (2,2);
+  EXPECT_EQ (por.getExpanded (),2);
+  EXPECT_EQ (por.getReduced (),1);
+  EXPECT_DOUBLE_EQ (por.getReductionRatio (),0.5);
+}
+
+/* Two processes running f: start -x++-> mid -x++-> end -> violated */
+struct TwoProcesses : public MiniMC::Tests::ProgramBuilder {
+  TwoProcesses () {
+	auto f = function ("f");
+	auto x = f.local ("x",int64);
+	auto start = f.location ("start");
+	auto mid = f.location ("mid");
+	auto end = f.location ("end");
+	auto violated = f.location ("violated",static_cast<AttrType> (Attributes::AssertViolated));
+	f.edge (start,mid,{add (x,x,1)});
+	f.edge (mid,end,{add (x,x,1)});
+	f.edge (end,violated);
+	ProgramBuilder::start (f,2);
+  }
+};
+
+std::vector<MiniMC::CPA::proc_id> expandedProcesses (const MiniMC::Model::Program& prgm, const MiniMC::Algorithms::PartialOrderReduction_ptr& por) {
+  MiniMC::Tests::LocationConcrete cpa;
+  auto transfer = cpa.makeTransfer ();
+  MiniMC::Algorithms::Generator gen (transfer,por);
+  auto [begin,end] = gen.generate (cpa.makeQuery ()->makeInitialState (prgm));
+  std::vector<MiniMC::CPA::proc_id> res;
+  for (auto it = begin; it != end; ++it)
+	res.push_back (it->proc);
+  return res;
+}
+
+MiniMC::Algorithms::SimulationManager makeManager (MiniMC::Tests::LocationConcrete& cpa, const MiniMC::Algorithms::PartialOrderReduction_ptr& por) {
+  return MiniMC::Algorithms::SimulationManager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												 .storer = cpa.makeStore (),
+												 .joiner = cpa.makeJoin (),
+												 .transfer = cpa.makeTransfer (),
+												 .por = por});
+}
+
+std::size_t storedStates (const MiniMC::Model::Program& prgm, const MiniMC::Algorithms::PartialOrderReduction_ptr& por) {
+  MiniMC::Tests::LocationConcrete cpa;
+  auto manager = makeManager (cpa,por);
+  manager.insert (cpa.makeQuery ()->makeInitialState (prgm));
+  EXPECT_EQ (manager.reachabilitySearch ({}),nullptr);
+  return manager.getStored ();
+}
+
+TEST(partialorder, onlyAmpleProcessExpanded) {
+  TwoProcesses prgm;
+  auto por = std::make_shared<MiniMC::Algorithms::PartialOrderReduction> (*prgm.prgm);
+  EXPECT_EQ (expandedProcesses (*prgm.prgm,nullptr),(std::vector<MiniMC::CPA::proc_id>{0,1}));
+  EXPECT_EQ (expandedProcesses (*prgm.prgm,por),(std::vector<MiniMC::CPA::proc_id>{0}));
+  EXPECT_EQ (por->getExpanded (),1);
+  EXPECT_EQ (por->getReduced (),1);
+}
+
+TEST(partialorder, fewerStatesStored) {
+  TwoProcesses prgm;
+  auto por = std::make_shared<MiniMC::Algorithms::PartialOrderReduction> (*prgm.prgm);
+  EXPECT_LT (storedStates (*prgm.prgm,por),storedStates (*prgm.prgm,nullptr));
+  EXPECT_GT (por->getReduced (),0);
+}
+
+TEST(partialorder, assertStillFound) {
+  TwoProcesses prgm;
+  MiniMC::Tests::LocationConcrete cpa;
+  auto manager = makeManager (cpa,std::make_shared<MiniMC::Algorithms::PartialOrderReduction> (*prgm.prgm));
+  manager.insert (cpa.makeQuery ()->makeInitialState (*prgm.prgm));
+  auto found = manager.reachabilitySearch ({.goal = [](const MiniMC::CPA::State_ptr& s) {return s->assertViolated ();}});
+  ASSERT_NE (found,nullptr);
+  EXPECT_TRUE (found->assertViolated ());
+}
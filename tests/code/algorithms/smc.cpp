@@ -0,0 +1,66 @@
+#include "algorithms/pprintgraph.hpp"
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+using MiniMC::Model::AttrType;
+using MiniMC::Model::Attributes;
+using MiniMC::Support::Statistical::ClopperPearson;
+using MiniMC::Support::Statistical::FixedEffort;
+
+/* Process 0 steps to a violated assert, process 1 loops. A trace of
+   length 2 violates the assert unless process 1 is picked twice. */
+struct Race : public MiniMC::Tests::ProgramBuilder {
+  Race () {
+	auto a = function ("a");
+	auto begin = a.location ("start");
+	auto violated = a.location ("violated",static_cast<AttrType> (Attributes::AssertViolated));
+	a.edge (begin,violated);
+	start (a);
+	auto b = function ("b");
+	auto loop = b.location ("loop");
+	b.edge (loop,loop);
+	start (b);
+  }
+};
+
+template<class SMC>
+struct Estimate {
+  std::size_t samples;
+  MiniMC::proba_t lower;
+  MiniMC::proba_t upper;
+};
+
+template<class SMC>
+Estimate<SMC> estimate (const MiniMC::Model::Program& prgm, const typename SMC::Options& smcoptions, std::size_t threads) {
+  MiniMC::Support::setSeed (11);
+  MiniMC::Algorithms::ProbaChecker<SMC> checker ({.len = 2, .smcoptions = smcoptions, .threads = threads, .batch = 8});
+  EXPECT_EQ (checker.run (prgm),MiniMC::Algorithms::Result::Success);
+  auto& smc = checker.getEstimator ();
+  return {smc.samples (),smc.lProbability (),smc.hProbability ()};
+}
+
+TEST(smc, clopperPearsonStopsAtTheSamePointOnAllThreadCounts) {
+  Race prgm;
+  ClopperPearson::Options opt {.width = 0.1, .alpha = 0.05};
+  auto sequential = estimate<ClopperPearson> (*prgm.prgm,opt,1);
+  EXPECT_GT (sequential.samples,0);
+  EXPECT_LE (sequential.lower,0.75);
+  EXPECT_GE (sequential.upper,0.75);
+  for (std::size_t threads : {2,4}) {
+	auto parallel = estimate<ClopperPearson> (*prgm.prgm,opt,threads);
+	EXPECT_EQ (parallel.samples,sequential.samples);
+	EXPECT_EQ (parallel.lower,sequential.lower);
+	EXPECT_EQ (parallel.upper,sequential.upper);
+  }
+}
+
+TEST(smc, fixedEffortGivesTheSameEstimateOnAllThreadCounts) {
+  Race prgm;
+  FixedEffort::Options opt {.effort = 1000, .alpha = 0.05};
+  auto sequential = estimate<FixedEffort> (*prgm.prgm,opt,1);
+  EXPECT_EQ (sequential.samples,1000);
+  auto parallel = estimate<FixedEffort> (*prgm.prgm,opt,4);
+  EXPECT_EQ (parallel.samples,1000);
+  EXPECT_EQ (parallel.lower,sequential.lower);
+  EXPECT_EQ (parallel.upper,sequential.upper);
+}
@@ -0,0 +1,70 @@
+#include "algorithms/symmetry.hpp"
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+using MiniMC::Tests::LocationConcrete;
+
+/* Entry wrappers as made by createEntryPoint after the started
+ * function is inlined: two processes run worker and one runs other */
+MiniMC::Model::Program_ptr makeProgram () {
+  MiniMC::Tests::ProgramBuilder builder;
+  for (std::string name : {"__minimc__entry_worker-1","__minimc__entry_other-2","__minimc__entry_worker-3"}) {
+	auto func = builder.function (name);
+	func.local ("x",builder.int64);
+	auto start = func.location ("start");
+	auto end = func.location ("end");
+	func.edge (start,end);
+	builder.start (func);
+  }
+  return builder.prgm;
+}
+
+TEST(symmetry, groupsProcessesOfTheSameFunction) {
+  auto prgm = makeProgram ();
+  MiniMC::Algorithms::SymmetryReduction symmetry (*prgm);
+  EXPECT_EQ (symmetry.getClasses (),(std::vector<std::vector<MiniMC::CPA::proc_id>>{{0,2}}));
+}
+
+TEST(symmetry, permutedStatesAreIdentified) {
+  auto prgm = makeProgram ();
+  LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto transfer = cpa.makeTransfer ();
+  auto symmetry = std::make_shared<MiniMC::Algorithms::SymmetryReduction> (*prgm);
+  auto init = query->makeInitialState (*prgm);
+  ASSERT_TRUE (symmetry->supports (init));
+
+  auto& entries = prgm->getEntryPoints ();
+  auto first = transfer->doTransfer (init,entries[0]->getCFG ()->getEdges ().at (0),0);
+  auto third = transfer->doTransfer (init,entries[2]->getCFG ()->getEdges ().at (0),2);
+  ASSERT_NE (first,nullptr);
+  ASSERT_NE (third,nullptr);
+  EXPECT_NE (first->hash (),third->hash ());
+
+  auto cfirst = symmetry->canonical (first);
+  auto cthird = symmetry->canonical (third);
+  EXPECT_EQ (cfirst->hash (),cthird->hash ());
+  auto joiner = cpa.makeJoin ();
+  EXPECT_TRUE (joiner->covers (cfirst,cthird));
+  EXPECT_EQ (symmetry->getPermuted (),1);
+
+  // Processes are moved along with their Locations
+  auto permuted = cfirst == first ? cthird : cfirst;
+  for (MiniMC::CPA::proc_id id = 0; id < entries.size (); ++id) {
+	auto& locations = entries[id]->getCFG ()->getLocations ();
+	EXPECT_NE (std::find (locations.begin (),locations.end (),permuted->getLocation (id)),locations.end ());
+  }
+}
+
+TEST(symmetry, transfererCanonicalises) {
+  auto prgm = makeProgram ();
+  LocationConcrete cpa;
+  auto symmetry = std::make_shared<MiniMC::Algorithms::SymmetryReduction> (*prgm);
+  MiniMC::Algorithms::SymmetricTransferer transfer (cpa.makeTransfer (),symmetry);
+  auto init = cpa.makeQuery ()->makeInitialState (*prgm);
+  auto& entries = prgm->getEntryPoints ();
+  auto first = transfer.doTransfer (init,entries[0]->getCFG ()->getEdges ().at (0),0);
+  auto third = transfer.doTransfer (init,entries[2]->getCFG ()->getEdges ().at (0),2);
+  EXPECT_EQ (first->hash (),third->hash ());
+  EXPECT_EQ (symmetry->getCanonicalised (),2);
+}
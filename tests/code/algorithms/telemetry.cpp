@@ -0,0 +1,52 @@
+#include "algorithms/simulationmanager.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+
+#include <thread>
+
+using MiniMC::Tests::IntState;
+using MiniMC::Tests::IntJoiner;
+
+TEST(telemetry, stripedCounterCountsAllThreads) {
+  MiniMC::Algorithms::StripedCounter counter;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+	threads.emplace_back ([&counter]() {
+	  for (int i = 0; i < 10000; ++i)
+		counter.add ();
+	});
+  for (auto& t : threads)
+	t.join ();
+  EXPECT_EQ (counter.value (),40000);
+}
+
+TEST(telemetry, countsStoredAndCoveredStates) {
+  auto joiner = std::make_shared<IntJoiner> ();
+  auto telemetry = std::make_shared<MiniMC::Algorithms::Telemetry> (std::chrono::seconds (0),nullptr);
+  MiniMC::Algorithms::SimulationManager manager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												  .storer = std::make_shared<MiniMC::CPA::HashStorer> (joiner),
+												  .joiner = joiner,
+												  .transfer = std::make_shared<MiniMC::CPA::Transferer> (),
+												  .telemetry = telemetry});
+  for (int i : {1,2,3,2,1})
+	manager.insert (std::make_shared<IntState> (i));
+
+  auto sample = telemetry->sample ();
+  EXPECT_EQ (sample.stored,3);
+  EXPECT_EQ (sample.covered,2);
+  EXPECT_EQ (sample.waiting,3);
+#ifdef __linux__
+  EXPECT_GT (sample.rss,0);
+#endif
+}
+
+TEST(telemetry, tickReportsWhenDue) {
+  std::size_t reports = 0;
+  MiniMC::Algorithms::Telemetry telemetry (std::chrono::seconds (1),[&reports](const MiniMC::Algorithms::TelemetrySample&) {reports++;});
+  telemetry.tick ();
+  EXPECT_EQ (reports,0);
+  std::this_thread::sleep_for (std::chrono::milliseconds (1100));
+  telemetry.tick ();
+  telemetry.tick ();
+  EXPECT_EQ (reports,1);
+}
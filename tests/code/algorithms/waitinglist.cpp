@@ -0,0 +1,82 @@
+#include "algorithms/waitinglist.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+#include <algorithm>
+
+using MiniMC::Tests::IntState;
+using MiniMC::Tests::value;
+
+MiniMC::CPA::State_ptr make (int val) {
+  return std::make_shared<IntState> (val);
+}
+
+std::vector<int> drain (MiniMC::Algorithms::WaitingList& list) {
+  std::vector<int> res;
+  while (!list.empty ())
+	res.push_back (value (list.pop ()));
+  return res;
+}
+
+TEST(waitinglist, depthFirst) {
+  MiniMC::Algorithms::WaitingList list (MiniMC::Algorithms::SearchOrder::DepthFirst);
+  for (int i = 0; i < 4; ++i)
+	list.push (make (i));
+  EXPECT_EQ (drain (list),(std::vector<int>{3,2,1,0}));
+}
+
+TEST(waitinglist, breadthFirst) {
+  MiniMC::Algorithms::WaitingList list (MiniMC::Algorithms::SearchOrder::BreadthFirst);
+  for (int i = 0; i < 4; ++i)
+	list.push (make (i));
+  EXPECT_EQ (value (list.pop ()),0);
+  list.push (make (4));
+  EXPECT_EQ (drain (list),(std::vector<int>{1,2,3,4}));
+}
+
+TEST(waitinglist, priority) {
+  MiniMC::Algorithms::WaitingList list (MiniMC::Algorithms::SearchOrder::Priority,[](auto& s) {return value (s) % 10;});
+  for (int v : {3,7,15,1,9,27})
+	list.push (make (v));
+  EXPECT_EQ (drain (list),(std::vector<int>{9,27,7,15,3,1}));
+}
+
+TEST(waitinglist, replace) {
+  for (auto order : {MiniMC::Algorithms::SearchOrder::DepthFirst,
+					 MiniMC::Algorithms::SearchOrder::BreadthFirst,
+					 MiniMC::Algorithms::SearchOrder::Priority}) {
+	MiniMC::Algorithms::WaitingList list (order,[](auto& s) {return value (s);});
+	std::vector<MiniMC::CPA::State_ptr> states;
+	for (int i = 0; i < 5; ++i) {
+	  states.push_back (make (i));
+	  list.push (states.back ());
+	}
+	list.pop ();
+	EXPECT_TRUE (list.replace (states[2],make (10)));
+	EXPECT_FALSE (list.replace (states[2],make (11)));
+	list.push (make (5));
+	auto res = drain (list);
+	EXPECT_EQ (res.size (),5);
+	EXPECT_EQ (std::count (res.begin (),res.end (),10),1);
+	EXPECT_EQ (std::count (res.begin (),res.end (),2),0);
+	if (order == MiniMC::Algorithms::SearchOrder::Priority)
+	  EXPECT_EQ (res.front (),10);
+  }
+}
+
+TEST(waitinglist, removeIf) {
+  for (auto order : {MiniMC::Algorithms::SearchOrder::DepthFirst,
+					 MiniMC::Algorithms::SearchOrder::Priority}) {
+	MiniMC::Algorithms::WaitingList list (order,[](auto& s) {return value (s);});
+	std::vector<MiniMC::CPA::State_ptr> states;
+	for (int i = 0; i < 6; ++i) {
+	  states.push_back (make (i));
+	  list.push (states.back ());
+	}
+	EXPECT_TRUE (list.replace (states[1],make (11)));
+	EXPECT_EQ (list.remove_if ([](auto& s) {return value (s) % 2 == 0;}),3);
+	EXPECT_TRUE (list.replace (states[3],make (13)));
+	auto res = drain (list);
+	std::sort (res.begin (),res.end ());
+	EXPECT_EQ (res,(std::vector<int>{5,11,13}));
+  }
+}
@@ -0,0 +1,68 @@
+#include "algorithms/simulationmanager.hpp"
+#include "cpa/approximate.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+#include "programbuilder.hpp"
+
+#include <cmath>
+
+using MiniMC::Tests::IntState;
+
+TEST(hashcompaction, seenStatesAreCovered) {
+  MiniMC::CPA::HashCompactionStorer store (1024);
+  auto s1 = std::make_shared<IntState> (17);
+  EXPECT_EQ (store.isCoveredByStore (s1),nullptr);
+  store.saveState (s1);
+  EXPECT_NE (store.isCoveredByStore (std::make_shared<IntState> (17)),nullptr);
+  EXPECT_EQ (store.isCoveredByStore (std::make_shared<IntState> (18)),nullptr);
+  EXPECT_EQ (store.stored (),1);
+  EXPECT_LT (store.omissionProbability (),1e-10);
+}
+
+TEST(hashcompaction, fullTableDropsStates) {
+  MiniMC::CPA::HashCompactionStorer store (4*sizeof(MiniMC::Hash::hash_t));
+  for (MiniMC::Hash::hash_t i = 1; i <= 8; ++i)
+	store.saveState (std::make_shared<IntState> (i));
+  EXPECT_EQ (store.stored (),3);
+  EXPECT_EQ (store.getDropped (),5);
+  EXPECT_EQ (store.omissionProbability (),1);
+  // Once States are dropped, unknown States count as visited
+  EXPECT_NE (store.isCoveredByStore (std::make_shared<IntState> (100)),nullptr);
+}
+
+TEST(hashcompaction, fullTableEndsSearchOfCyclicProgram) {
+  MiniMC::Tests::Counter counter;
+  auto cpa = std::make_shared<MiniMC::Tests::LocationConcrete> ();
+  auto store = std::make_shared<MiniMC::CPA::HashCompactionStorer> (16*sizeof(MiniMC::Hash::hash_t));
+  MiniMC::Algorithms::SimulationManager manager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												  .storer = store,
+												  .joiner = cpa->makeJoin (),
+												  .transfer = cpa->makeTransfer ()});
+  manager.insert (cpa->makeQuery ()->makeInitialState (*counter.prgm));
+  EXPECT_EQ (manager.reachabilitySearch ({}),nullptr);
+  EXPECT_EQ (store->stored (),15);
+  EXPECT_GT (store->getDropped (),0);
+  EXPECT_EQ (manager.getWSize (),0);
+}
+
+TEST(bitstate, seenStatesAreCovered) {
+  MiniMC::CPA::BitStateStorer store (1024);
+  for (MiniMC::Hash::hash_t i = 0; i < 100; ++i)
+	store.saveState (std::make_shared<IntState> (i*7919));
+  for (MiniMC::Hash::hash_t i = 0; i < 100; ++i)
+	EXPECT_NE (store.isCoveredByStore (std::make_shared<IntState> (i*7919)),nullptr);
+  EXPECT_GT (store.omissionProbability (),0);
+  EXPECT_LT (store.omissionProbability (),0.01);
+}
+
+TEST(bitstate, omissionCoversAllSavedStates) {
+  const std::size_t k = 3;
+  MiniMC::CPA::BitStateStorer store (16,k);
+  for (MiniMC::Hash::hash_t i = 0; i < 20; ++i)
+	store.saveState (std::make_shared<IntState> (i*7919));
+  // The chance that the last State alone was omitted is at most the
+  // fill of the array to the k'th power
+  auto last = std::pow (-std::expm1 (-static_cast<double> (k) * 20 / 128),k);
+  EXPECT_GT (store.omissionProbability (),last);
+  EXPECT_LE (store.omissionProbability (),1);
+}
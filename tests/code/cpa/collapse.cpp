@@ -0,0 +1,79 @@
+#include "algorithms/simulationmanager.hpp"
+#include "cpa/collapse.hpp"
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+using MiniMC::Tests::LocationConcrete;
+
+/* Two processes running a function with two locations connected by an edge */
+MiniMC::Model::Program_ptr makeProgram () {
+  MiniMC::Tests::ProgramBuilder builder;
+  builder.global ("g",builder.prgm->getTypeFactory ()->makeIntegerType (32));
+  auto main = builder.function ("main");
+  main.local ("x",builder.int64);
+  auto start = main.location ("start");
+  auto end = main.location ("end");
+  main.edge (start,end);
+  builder.start (main,2);
+  return builder.prgm;
+}
+
+struct IntBox {
+  int val;
+  bool operator== (const IntBox& oth) const {return val == oth.val;}
+};
+
+TEST(interntable, equalObjectsAreShared) {
+  MiniMC::CPA::InternTable<IntBox> table;
+  auto a = std::make_shared<IntBox> (IntBox{1});
+  auto b = std::make_shared<IntBox> (IntBox{1});
+  auto c = std::make_shared<IntBox> (IntBox{2});
+  EXPECT_EQ (table.intern (a,1),a);
+  EXPECT_EQ (table.intern (b,1),a);
+  // Hash collisions are resolved by comparing the objects
+  EXPECT_EQ (table.intern (c,1),c);
+  EXPECT_EQ (table.size (),2);
+  EXPECT_EQ (table.getLookups (),3);
+}
+
+TEST(collapse, storedStatesShareEqualComponents) {
+  auto prgm = makeProgram ();
+  LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto joiner = cpa.makeJoin ();
+  MiniMC::CPA::CollapseStorer store (joiner);
+
+  auto& edges = prgm->getFunction (0)->getCFG ()->getEdges ();
+  auto first = query->makeInitialState (*prgm);
+  auto second = cpa.makeTransfer ()->doTransfer (query->makeInitialState (*prgm),edges.at (0),0);
+  ASSERT_NE (second,nullptr);
+  auto hash = second->hash ();
+  store.saveState (first);
+  store.saveState (second);
+  EXPECT_EQ (second->hash (),hash);
+  EXPECT_NE (store.isCoveredByStore (second),nullptr);
+
+  std::map<std::string,std::pair<std::size_t,std::size_t>> stats;
+  for (auto& [name,table] : store.getInterner ())
+	stats[name] = {table->size (),table->getLookups ()};
+  // Globals and the two (equal) process frames of each State
+  EXPECT_EQ (stats["Variable frames"],(std::pair<std::size_t,std::size_t>{2,6}));
+  EXPECT_EQ (stats["Heaps"],(std::pair<std::size_t,std::size_t>{1,2}));
+  EXPECT_EQ (store.getStored (),2);
+}
+
+TEST(collapse, searchedSequentiallySoStatesAreInterned) {
+  auto prgm = makeProgram ();
+  LocationConcrete cpa;
+  auto store = std::make_shared<MiniMC::CPA::CollapseStorer> (cpa.makeJoin ());
+  MiniMC::Algorithms::SimulationManager manager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												  .storer = store,
+												  .joiner = cpa.makeJoin (),
+												  .transfer = cpa.makeTransfer (),
+												  .threads = 4});
+  EXPECT_FALSE (manager.supportsParallel ());
+  manager.insert (cpa.makeQuery ()->makeInitialState (*prgm));
+  EXPECT_EQ (manager.reachabilitySearch ({}),nullptr);
+  EXPECT_EQ (store->getStored (),4);
+  EXPECT_TRUE (manager.getThreadStatistics ().empty ());
+}
@@ -0,0 +1,77 @@
+#include "cpa/compound.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+
+using MiniMC::Tests::IntState;
+using MiniMC::Tests::IntJoiner;
+
+template<int init>
+struct IntQuery : public MiniMC::CPA::StateQuery {
+  MiniMC::CPA::State_ptr makeInitialState (const MiniMC::Model::Program&) override {return std::make_shared<IntState> (init);}
+};
+
+/* Increments the value and blocks once it reaches limit */
+template<int limit>
+struct IntTransfer : public MiniMC::CPA::Transferer {
+  MiniMC::CPA::State_ptr doTransfer (const MiniMC::CPA::State_ptr& s, const MiniMC::Model::Edge_ptr&, MiniMC::CPA::proc_id) override {
+	auto val = static_cast<const IntState&> (*s).val;
+	if (val >= limit)
+	  return nullptr;
+	return std::make_shared<IntState> (val+1);
+  }
+};
+
+template<int init,int limit>
+using IntCPA = MiniMC::CPA::CPADef<IntQuery<init>,IntTransfer<limit>,IntJoiner,MiniMC::CPA::HashStorer,MiniMC::CPA::PrevalidateSetup>;
+
+using TestCompound = MiniMC::CPA::Compounds::Compound<1,IntCPA<0,10>,IntCPA<5,6>>;
+
+MiniMC::Model::Program program (std::make_shared<MiniMC::Model::TypeFactory64> (),
+								std::make_shared<MiniMC::Model::ConstantFactory64> ());
+
+int value (const MiniMC::CPA::State_ptr& s, std::size_t i) {
+  return static_cast<const IntState&> (*static_cast<const TestCompound::CState&> (*s).get (i)).val;
+}
+
+TEST(staticcompound, transferAllComponents) {
+  TestCompound cpa;
+  auto init = cpa.makeQuery ()->makeInitialState (program);
+  auto succ = cpa.makeTransfer ()->doTransfer (init,nullptr,0);
+  ASSERT_NE (succ,nullptr);
+  EXPECT_EQ (value (succ,0),1);
+  EXPECT_EQ (value (succ,1),6);
+}
+
+TEST(staticcompound, blockedComponentBlocksCompound) {
+  TestCompound cpa;
+  auto transfer = cpa.makeTransfer ();
+  auto init = cpa.makeQuery ()->makeInitialState (program);
+  auto succ = transfer->doTransfer (init,nullptr,0);
+  EXPECT_EQ (transfer->doTransfer (succ,nullptr,0),nullptr);
+}
+
+TEST(staticcompound, coversComponentWise) {
+  TestCompound cpa;
+  auto joiner = cpa.makeJoin ();
+  auto init = cpa.makeQuery ()->makeInitialState (program);
+  auto succ = cpa.makeTransfer ()->doTransfer (init,nullptr,0);
+  EXPECT_TRUE (joiner->covers (init,init->copy ()));
+  EXPECT_FALSE (joiner->covers (init,succ));
+  EXPECT_NE (std::dynamic_pointer_cast<MiniMC::CPA::HashStorer> (cpa.makeStore ()),nullptr);
+}
+
+TEST(staticcompound, concretizerOfAskedComponent) {
+  TestCompound cpa;
+  auto init = cpa.makeQuery ()->makeInitialState (program);
+  auto& s = static_cast<const TestCompound::CState&> (*init);
+  EXPECT_EQ (init->getConcretizer (),s.get (1)->getConcretizer ());
+  EXPECT_NE (init->getConcretizer (),s.get (0)->getConcretizer ());
+}
+
+TEST(compound, copyKeepsAskedComponent) {
+  auto first = std::make_shared<IntState> (1);
+  auto second = std::make_shared<IntState> (2);
+  MiniMC::CPA::Compounds::State s ({first,second},0);
+  EXPECT_EQ (s.getConcretizer (),first->getConcretizer ());
+  EXPECT_EQ (s.copy ()->getConcretizer (),first->getConcretizer ());
+}
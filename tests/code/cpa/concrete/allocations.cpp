@@ -0,0 +1,60 @@
+#include "tacimpl.hpp"
+#include "cmpimpl.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  std::atomic<std::size_t> allocations = 0;
+}
+
+void* operator new (std::size_t size) {
+  allocations++;
+  if (void* ptr = std::malloc (size))
+	return ptr;
+  throw std::bad_alloc ();
+}
+
+void operator delete (void* ptr) noexcept {
+  std::free (ptr);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept {
+  std::free (ptr);
+}
+
+template<class T>
+double allocationsPerInstruction (std::size_t iterations) {
+  MiniMC::Util::Array larr (sizeof(T));
+  MiniMC::Util::Array rarr (sizeof(T));
+  larr.template set<T> (0,3);
+  rarr.template set<T> (0,5);
+  std::size_t before = allocations;
+  for (std::size_t i = 0; i < iterations; ++i) {
+	auto sum = MiniMC::CPA::Concrete::Steptacexec<MiniMC::Model::InstructionCode::Add> (larr,rarr);
+	auto cmp = MiniMC::CPA::Concrete::Stepcmpexec<MiniMC::Model::InstructionCode::ICMP_ULT> (larr,sum);
+	EXPECT_EQ (cmp.getSize (),1);
+	larr = std::move (sum);
+  }
+  return static_cast<double> (allocations - before) / (2*iterations);
+}
+
+TEST(ArrayAllocations, IntegerInstructionsDoNotAllocate) {
+  EXPECT_EQ (allocationsPerInstruction<MiniMC::uint8_t> (1000),0);
+  EXPECT_EQ (allocationsPerInstruction<MiniMC::uint16_t> (1000),0);
+  EXPECT_EQ (allocationsPerInstruction<MiniMC::uint32_t> (1000),0);
+  EXPECT_EQ (allocationsPerInstruction<MiniMC::uint64_t> (1000),0);
+}
+
+TEST(ArrayAllocations, LargeArraysStillAllocate) {
+  std::size_t before = allocations;
+  MiniMC::Util::Array arr (MiniMC::Util::Array::InlineSize+1);
+  MiniMC::Util::Array copy (arr);
+  EXPECT_EQ (allocations - before,2);
+  EXPECT_EQ (copy,arr);
+  MiniMC::Util::Array moved (std::move (copy));
+  EXPECT_EQ (allocations - before,2);
+  EXPECT_EQ (moved,arr);
+}
@@ -0,0 +1,54 @@
+#include "decoded.hpp"
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+/* A single edge doing x = x + 1; g = x */
+struct Counter : public MiniMC::Tests::ProgramBuilder {
+  Counter () {
+	g = global ("g",int64);
+	auto main = function ("main");
+	x = main.local ("x",int64);
+	auto loc = main.location ("loop");
+	edge = main.edge (loc,loc,{add (x,x,1),
+							   MiniMC::Model::InstBuilder<MiniMC::Model::InstructionCode::Assign> {}.setResult (g).setValue (x).BuildInstruction ()});
+	start (main);
+  }
+
+  MiniMC::Model::Variable_ptr g;
+  MiniMC::Model::Variable_ptr x;
+  MiniMC::Model::Edge_ptr edge;
+};
+
+TEST(decoded, operandsAreResolved) {
+  Counter counter;
+  auto& stream = counter.edge->getAttribute<MiniMC::Model::AttributeType::Instructions> ();
+  MiniMC::CPA::Concrete::DecodedStream decoded (stream);
+  ASSERT_EQ (decoded.instr.size (),2);
+
+  auto& add = decoded.instr[0];
+  EXPECT_EQ (add.getOpcode (),MiniMC::Model::InstructionCode::Add);
+  MiniMC::Model::InstHelper<MiniMC::Model::InstructionCode::Add> helper (add.getSource ());
+  auto& res = add.operand (helper.getResult ());
+  EXPECT_EQ (res.kind,MiniMC::CPA::Concrete::Operand::Kind::Local);
+  EXPECT_EQ (res.index,counter.x->getId ());
+  EXPECT_EQ (res.size,8);
+  auto& right = add.operand (helper.getRightOp ());
+  EXPECT_EQ (right.kind,MiniMC::CPA::Concrete::Operand::Kind::Immediate);
+  EXPECT_EQ (right.value.read<MiniMC::uint64_t> (),1);
+
+  auto& assign = decoded.instr[1];
+  MiniMC::Model::InstHelper<MiniMC::Model::InstructionCode::Assign> ahelper (assign.getSource ());
+  EXPECT_EQ (assign.operand (ahelper.getResult ()).kind,MiniMC::CPA::Concrete::Operand::Kind::Global);
+}
+
+TEST(decoded, transferReusesDecodedStream) {
+  Counter counter;
+  MiniMC::CPA::Concrete::CPA cpa;
+  auto transfer = cpa.makeTransfer ();
+  auto state = cpa.makeQuery ()->makeInitialState (*counter.prgm);
+  for (int i = 0; i < 3; ++i)
+	state = transfer->doTransfer (state,counter.edge,0);
+  auto concretizer = state->getConcretizer ();
+  EXPECT_EQ (concretizer->evaluate (0,counter.x).read<MiniMC::uint64_t> (),3);
+  EXPECT_EQ (concretizer->evaluate (0,counter.g).read<MiniMC::uint64_t> (),3);
+}
@@ -0,0 +1,109 @@
+#include "heap.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+  MiniMC::Util::Array bytes (std::size_t size, MiniMC::uint8_t val) {
+	MiniMC::Util::Array arr (size);
+	for (std::size_t i = 0; i < size; ++i)
+	  arr.set (i,val);
+	return arr;
+  }
+}
+
+TEST(heap, writeReadAcrossChunks) {
+  MiniMC::CPA::Concrete::Heap heap;
+  auto ptr = heap.allocate (4096);
+  auto offset = MiniMC::CPA::Concrete::HeapChunk::Size - 3;
+  auto data = bytes (8,7);
+  heap.write (data,MiniMC::Support::makeHeapPointer (MiniMC::Support::getBase (ptr),offset));
+
+  MiniMC::Util::Array res (8);
+  heap.read (res,MiniMC::Support::makeHeapPointer (MiniMC::Support::getBase (ptr),offset));
+  EXPECT_EQ (res,data);
+}
+
+TEST(heap, copyIsUnaffectedByWrite) {
+  MiniMC::CPA::Concrete::Heap heap;
+  auto ptr = heap.allocate (4096);
+  auto copy = heap;
+  heap.write (bytes (4,1),ptr);
+
+  MiniMC::Util::Array res (4);
+  copy.read (res,ptr);
+  EXPECT_EQ (res,bytes (4,0));
+  EXPECT_FALSE (copy == heap);
+}
+
+TEST(heap, hashFollowsContents) {
+  MiniMC::CPA::Concrete::Heap left;
+  MiniMC::CPA::Concrete::Heap right;
+  auto lptr = left.allocate (1024);
+  auto rptr = right.allocate (1024);
+  EXPECT_EQ (left.hash (),right.hash ());
+
+  left.write (bytes (4,1),lptr);
+  EXPECT_NE (left.hash (),right.hash ());
+
+  right.write (bytes (4,2),rptr);
+  right.write (bytes (4,1),rptr);
+  EXPECT_EQ (left.hash (),right.hash ());
+  EXPECT_TRUE (left == right);
+
+  MiniMC::CPA::Concrete::Heap fresh;
+  fresh.allocate (1024);
+  left.write (bytes (4,0),lptr);
+  EXPECT_EQ (left.hash (),fresh.hash ());
+}
+
+TEST(heap, serializeRoundtrip) {
+  MiniMC::CPA::Concrete::Heap heap;
+  auto ptr = heap.allocate (4096);
+  heap.write (bytes (8,7),MiniMC::Support::makeHeapPointer (MiniMC::Support::getBase (ptr),300));
+  heap.free (heap.allocate (10));
+  heap.allocate (0);
+
+  std::vector<MiniMC::uint8_t> buffer;
+  MiniMC::Support::Writer writer (buffer);
+  heap.serialize (writer);
+  // Only the one written chunk is stored in full
+  EXPECT_LT (buffer.size (),MiniMC::CPA::Concrete::HeapChunk::Size+64);
+
+  MiniMC::Support::Reader reader (buffer);
+  auto res = MiniMC::CPA::Concrete::Heap::deserialize (reader);
+  EXPECT_TRUE (reader.atEnd ());
+  EXPECT_TRUE (res == heap);
+  EXPECT_EQ (res.hash (),heap.hash ());
+}
+
+TEST(heap, truncatedDataThrows) {
+  MiniMC::CPA::Concrete::Heap heap;
+  heap.write (bytes (4,1),heap.allocate (16));
+  std::vector<MiniMC::uint8_t> buffer;
+  MiniMC::Support::Writer writer (buffer);
+  heap.serialize (writer);
+
+  MiniMC::Support::Reader reader (buffer.data (),buffer.size ()-1);
+  EXPECT_THROW (MiniMC::CPA::Concrete::Heap::deserialize (reader),MiniMC::Support::SerializationError);
+}
+
+TEST(heap, internChunksSharesEqualChunks) {
+  MiniMC::CPA::Concrete::Heap left;
+  MiniMC::CPA::Concrete::Heap right;
+  auto lptr = left.allocate (1024);
+  auto rptr = right.allocate (1024);
+  left.write (bytes (4,1),lptr);
+  right.write (bytes (4,1),rptr);
+
+  MiniMC::CPA::InternTable<MiniMC::CPA::Concrete::HeapChunk> table;
+  left.internChunks (table);
+  right.internChunks (table);
+  // The written chunk and the zero chunk
+  EXPECT_EQ (table.size (),2);
+  EXPECT_TRUE (left == right);
+
+  // Writing to a shared chunk leaves the other heap alone
+  right.write (bytes (4,2),rptr);
+  MiniMC::Util::Array res (4);
+  left.read (res,lptr);
+  EXPECT_EQ (res,bytes (4,1));
+}
@@ -0,0 +1,159 @@
+#include "algorithms/enumstates.hpp"
+#include "algorithms/reach.hpp"
+#include "algorithms/simulationmanager.hpp"
+#include "cpa/external.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+#include "programbuilder.hpp"
+#include "support/benchruns.hpp"
+
+#include <fstream>
+#include <sstream>
+
+using MiniMC::Tests::IntState;
+
+TEST(external, inMemoryDuplicatesAreCovered) {
+  MiniMC::CPA::ExternalStorer store (1024,std::filesystem::temp_directory_path ());
+  auto s1 = std::make_shared<IntState> (17);
+  EXPECT_EQ (store.isCoveredByStore (s1),nullptr);
+  store.saveState (s1);
+  EXPECT_NE (store.isCoveredByStore (std::make_shared<IntState> (17)),nullptr);
+  EXPECT_EQ (store.stored (),1);
+}
+
+TEST(external, flushReportsStatesAlreadyOnDisk) {
+  MiniMC::CPA::ExternalStorer store (1024,std::filesystem::temp_directory_path ());
+  std::vector<MiniMC::CPA::State_ptr> states;
+  for (MiniMC::Hash::hash_t i = 0; i < 10; ++i) {
+	states.push_back (std::make_shared<IntState> (i*3));
+	store.saveState (states.back ());
+  }
+  EXPECT_TRUE (store.flush ().empty ());
+  EXPECT_EQ (store.stored (),10);
+  
+  auto dup = std::make_shared<IntState> (9);
+  auto fresh = std::make_shared<IntState> (10);
+  EXPECT_EQ (store.isCoveredByStore (dup),nullptr);
+  store.saveState (dup);
+  store.saveState (fresh);
+  auto duplicates = store.flush ();
+  ASSERT_EQ (duplicates.size (),1);
+  EXPECT_EQ (duplicates.count (dup.get ()),1);
+  EXPECT_EQ (store.stored (),11);
+  EXPECT_EQ (store.diskBytes (),11*sizeof(MiniMC::Hash::hash_t));
+}
+
+TEST(external, fullWhenBudgetReached) {
+  MiniMC::CPA::ExternalStorer store (1,std::filesystem::temp_directory_path ());
+  EXPECT_FALSE (store.full ());
+  store.saveState (std::make_shared<IntState> (1));
+  EXPECT_TRUE (store.full ());
+  store.flush ();
+  EXPECT_FALSE (store.full ());
+}
+
+TEST(external, queueReadsBackInOrder) {
+  // A buffer smaller than a record makes every push and pop go to the file
+  MiniMC::CPA::ExternalQueue queue (std::filesystem::temp_directory_path (),
+									[](MiniMC::Support::Reader& reader) {return IntState::read (reader);},
+									1);
+  EXPECT_EQ (queue.pop (),nullptr);
+  for (MiniMC::Hash::hash_t i = 0; i < 1000; ++i)
+	queue.push (std::make_shared<IntState> (i*i));
+  EXPECT_EQ (queue.size (),1000);
+  for (MiniMC::Hash::hash_t i = 0; i < 1000; ++i) {
+	auto s = queue.pop ();
+	ASSERT_NE (s,nullptr);
+	EXPECT_EQ (s->hash (),i*i);
+  }
+  EXPECT_EQ (queue.size (),0);
+  EXPECT_EQ (queue.pop (),nullptr);
+  EXPECT_THROW (queue.push (std::make_shared<IntState> (1)),MiniMC::Support::Exception);
+}
+
+/* processes processes each walking through a chain of length locations */
+struct Chains : public MiniMC::Tests::ProgramBuilder {
+  Chains (std::size_t processes, std::size_t length) {
+	auto main = function ("main");
+	auto prev = main.location ("l0");
+	for (std::size_t i = 1; i < length; ++i) {
+	  auto loc = main.location ("l" + std::to_string (i));
+	  main.edge (prev,loc);
+	  prev = loc;
+	}
+	start (main,processes);
+  }
+};
+
+TEST(external, searchSpillingLayersFindsAllStates) {
+  Chains chains (3,4);
+  MiniMC::Tests::LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto store = std::make_shared<MiniMC::CPA::ExternalStorer> (4*48,std::filesystem::temp_directory_path ());
+  MiniMC::Algorithms::SimulationManager manager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												  .storer = store,
+												  .joiner = cpa.makeJoin (),
+												  .transfer = cpa.makeTransfer (),
+												  .load = [&](MiniMC::Support::Reader& reader) {return query->deserialize (reader,*chains.prgm);}});
+  manager.insert (query->makeInitialState (*chains.prgm));
+  EXPECT_EQ (manager.reachabilitySearch ({}),nullptr);
+  EXPECT_EQ (store->stored (),4*4*4);
+  EXPECT_EQ (manager.getPSize (),4*4*4);
+  EXPECT_GT (store->getFlushes (),3);
+  EXPECT_EQ (manager.getWSize (),0);
+}
+
+TEST(external, budgetStopReadsLayersBack) {
+  Chains chains (3,4);
+  MiniMC::Tests::LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto store = std::make_shared<MiniMC::CPA::ExternalStorer> (4*48,std::filesystem::temp_directory_path ());
+  MiniMC::Algorithms::SimulationManager manager ({.storage = [](const MiniMC::CPA::State_ptr&) {return true;},
+												  .storer = store,
+												  .joiner = cpa.makeJoin (),
+												  .transfer = cpa.makeTransfer (),
+												  .budget = std::make_shared<MiniMC::Algorithms::BudgetGuard> (MiniMC::Algorithms::Budget {.states = 20}),
+												  .load = [&](MiniMC::Support::Reader& reader) {return query->deserialize (reader,*chains.prgm);}});
+  manager.insert (query->makeInitialState (*chains.prgm));
+  EXPECT_EQ (manager.reachabilitySearch ({}),nullptr);
+  EXPECT_EQ (manager.budgetExceeded (),MiniMC::Algorithms::BudgetExceeded::States);
+  EXPECT_GT (manager.getWSize (),0);
+  manager.for_each_waiting ([](const MiniMC::CPA::State_ptr& s) {EXPECT_EQ (s->nbOfProcesses (),3);});
+}
+
+MiniMC::CPA::CPA_ptr externalCPA () {
+  return std::make_shared<MiniMC::CPA::ApproximateStorageCPA> (std::make_shared<MiniMC::Tests::LocationConcrete> (),
+															   MiniMC::CPA::StorageMode::External,4*48,
+															   std::filesystem::temp_directory_path ().string ());
+}
+
+std::string readStatistics (const std::filesystem::path& file) {
+  std::stringstream json;
+  json << std::ifstream (file).rdbuf ();
+  std::filesystem::remove (file);
+  return json.str ();
+}
+
+std::size_t enumerate (const MiniMC::CPA::CPA_ptr& cpa, const MiniMC::Model::Program& prgm) {
+  auto stats = std::filesystem::temp_directory_path () / "minimc-external-enum.json";
+  MiniMC::Algorithms::EnumStates enumerate ({.cpa = cpa, .statsInterval = std::chrono::seconds (0), .statsOut = stats.string ()});
+  EXPECT_EQ (enumerate.run (prgm),MiniMC::Algorithms::Result::Success);
+  return MiniMC::Support::Bench::readStatistic (readStatistics (stats),"explored");
+}
+
+TEST(external, enumStatesCompletes) {
+  Chains chains (3,4);
+  EXPECT_EQ (enumerate (externalCPA (),*chains.prgm),enumerate (std::make_shared<MiniMC::Tests::LocationConcrete> (),*chains.prgm));
+}
+
+TEST(external, randomRestartsComplete) {
+  Chains chains (3,4);
+  auto stats = std::filesystem::temp_directory_path () / "minimc-external-restarts.json";
+  MiniMC::Algorithms::Reachability reach ({.cpa = externalCPA (),
+										   .search = MiniMC::Algorithms::SearchStrategy::RandomRestart,
+										   .statsInterval = std::chrono::seconds (0),
+										   .statsOut = stats.string ()});
+  EXPECT_EQ (reach.run (*chains.prgm),MiniMC::Algorithms::Result::Success);
+  EXPECT_EQ (reach.getAnalysisResult ().result,MiniMC::Algorithms::Reachability::ReachabilityResult::NotFound);
+  EXPECT_EQ (MiniMC::Support::Bench::readString (readStatistics (stats),"result"),"NotFound");
+}
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "programbuilder.hpp"
+
+#include <limits>
+
+using MiniMC::Tests::LocationConcrete;
+
+/* Two locations connected by an edge, and a few global and local variables */
+MiniMC::Model::Program_ptr makeProgram () {
+  MiniMC::Tests::ProgramBuilder builder;
+  auto& tfac = builder.prgm->getTypeFactory ();
+  builder.global ("g",tfac->makeIntegerType (32));
+  auto main = builder.function ("main");
+  main.local ("x",builder.int64);
+  main.local ("b",tfac->makeBoolType ());
+  auto start = main.location ("start");
+  auto end = main.location ("end");
+  main.edge (start,end);
+  builder.start (main);
+  return builder.prgm;
+}
+
+TEST(serialize, varintRoundtrip) {
+  std::vector<MiniMC::uint8_t> buffer;
+  MiniMC::Support::Writer writer (buffer);
+  writer.varint (0);
+  writer.varint (127);
+  writer.varint (128);
+  writer.varint (std::numeric_limits<MiniMC::uint64_t>::max ());
+  EXPECT_EQ (buffer.size (),1+1+2+10);
+
+  MiniMC::Support::Reader reader (buffer);
+  EXPECT_EQ (reader.varint (),0);
+  EXPECT_EQ (reader.varint (),127);
+  EXPECT_EQ (reader.varint (),128);
+  EXPECT_EQ (reader.varint (),std::numeric_limits<MiniMC::uint64_t>::max ());
+  EXPECT_TRUE (reader.atEnd ());
+  EXPECT_THROW (reader.varint (),MiniMC::Support::SerializationError);
+}
+
+TEST(serialize, locationConcreteRoundtrip) {
+  auto prgm = makeProgram ();
+  LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto init = query->makeInitialState (*prgm);
+  auto& edges = prgm->getFunction (0)->getCFG ()->getEdges ();
+  auto succ = cpa.makeTransfer ()->doTransfer (init,edges.at (0),0);
+  ASSERT_NE (succ,nullptr);
+
+  auto joiner = cpa.makeJoin ();
+  for (auto& state : {init,succ}) {
+	auto data = MiniMC::CPA::serializeState (*state);
+	auto res = MiniMC::CPA::deserializeState (*query,*prgm,data.data (),data.size ());
+	EXPECT_EQ (res->hash (),state->hash ());
+	EXPECT_EQ (res->getLocation (0),state->getLocation (0));
+	EXPECT_TRUE (joiner->covers (res,state));
+	EXPECT_TRUE (joiner->covers (state,res));
+  }
+}
+
+TEST(serialize, rejectsOtherVersionsAndTrailingBytes) {
+  auto prgm = makeProgram ();
+  LocationConcrete cpa;
+  auto query = cpa.makeQuery ();
+  auto data = MiniMC::CPA::serializeState (*query->makeInitialState (*prgm));
+
+  auto other = data;
+  other[0]++;
+  EXPECT_THROW (MiniMC::CPA::deserializeState (*query,*prgm,other.data (),other.size ()),MiniMC::Support::SerializationError);
+  auto longer = data;
+  longer.push_back (0);
+  EXPECT_THROW (MiniMC::CPA::deserializeState (*query,*prgm,longer.data (),longer.size ()),MiniMC::Support::SerializationError);
+  EXPECT_THROW (MiniMC::CPA::deserializeState (*query,*prgm,data.data (),data.size ()-1),MiniMC::Support::SerializationError);
+}
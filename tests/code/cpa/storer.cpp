@@ -0,0 +1,37 @@
+#include "cpa/interface.hpp"
+#include "gtest/gtest.h"
+#include "intstate.hpp"
+
+using MiniMC::Tests::IntState;
+using MiniMC::Tests::IntJoiner;
+
+TEST(hashstorer, coveredAfterSave) {
+  MiniMC::CPA::HashStorer store (std::make_shared<IntJoiner> ());
+  auto s1 = std::make_shared<IntState> (1,1);
+  auto s2 = std::make_shared<IntState> (1,1);
+  EXPECT_EQ (store.isCoveredByStore (s1),nullptr);
+  store.saveState (s1);
+  EXPECT_EQ (store.isCoveredByStore (s2),s1);
+}
+
+TEST(hashstorer, collidingHashesAreDistinct) {
+  MiniMC::CPA::HashStorer store (std::make_shared<IntJoiner> ());
+  auto s1 = std::make_shared<IntState> (1,5);
+  auto s2 = std::make_shared<IntState> (2,5);
+  store.saveState (s1);
+  EXPECT_EQ (store.isCoveredByStore (s2),nullptr);
+  store.saveState (s2);
+  EXPECT_EQ (store.isCoveredByStore (std::make_shared<IntState> (2,5)),s2);
+  EXPECT_EQ (std::distance (store.stored_begin (),store.stored_end ()),2);
+}
+
+TEST(hashstorer, joinWithoutJoinOperationSaves) {
+  MiniMC::CPA::HashStorer store (std::make_shared<IntJoiner> ());
+  MiniMC::CPA::IStorer::StorageTag tag;
+  auto s1 = std::make_shared<IntState> (3,3);
+  store.saveState (s1,&tag);
+  auto join = store.joinState (std::make_shared<IntState> (4,4));
+  EXPECT_EQ (join.orig,nullptr);
+  EXPECT_EQ (store.loadState (tag),s1);
+  EXPECT_EQ (std::distance (store.stored_begin (),store.stored_end ()),2);
+}
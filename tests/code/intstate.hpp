@@ -0,0 +1,64 @@
+#ifndef _TESTS_INTSTATE__
+#define _TESTS_INTSTATE__
+
+#include "cpa/interface.hpp"
+#include "support/serialize.hpp"
+
+#include <memory>
+
+namespace MiniMC {
+  namespace Tests {
+
+	/**
+	 * State holding a single number, for testing stores, waiting lists
+	 * and searches without a program. Its hash is the number unless
+	 * another one is given, so tests can make States collide.
+	 */
+	class IntState : public MiniMC::CPA::State {
+	public:
+	  IntState (int val) : val(val),h(val) {}
+	  IntState (int val, MiniMC::Hash::hash_t h) : val(val),h(h) {}
+	  MiniMC::Hash::hash_t hash (MiniMC::Hash::seed_t seed = 0) const override {return h;}
+	  std::shared_ptr<MiniMC::CPA::State> copy () const override {return std::make_shared<IntState> (*this);}
+	  const MiniMC::CPA::Concretizer_ptr getConcretizer () const override {return concretizer;}
+	  void serialize (MiniMC::Support::Writer& writer) const override {
+		writer.varint (val);
+		writer.varint (h);
+	  }
+
+	  /**
+	   * @return IntState written by serialize
+	   */
+	  static std::shared_ptr<IntState> read (MiniMC::Support::Reader& reader) {
+		auto val = static_cast<int> (reader.varint ());
+		return std::make_shared<IntState> (val,reader.varint ());
+	  }
+
+	  int val;
+	  MiniMC::Hash::hash_t h;
+	  MiniMC::CPA::Concretizer_ptr concretizer = std::make_shared<MiniMC::CPA::Concretizer> ();
+	};
+
+	inline int value (const MiniMC::CPA::State_ptr& s) {
+	  return static_cast<const IntState&> (*s).val;
+	}
+
+	/**
+	 * IntStates cover each other if they hold the same number
+	 */
+	struct IntJoiner : public MiniMC::CPA::Joiner {
+	  bool covers (const MiniMC::CPA::State_ptr& l, const MiniMC::CPA::State_ptr& r) override {
+		return value (l) == value (r);
+	  }
+	};
+
+	struct IntQuery : public MiniMC::CPA::StateQuery {
+	  MiniMC::CPA::State_ptr deserialize (MiniMC::Support::Reader& reader, const MiniMC::Model::Program&) override {
+		return IntState::read (reader);
+	  }
+	};
+
+  } // namespace Tests
+} // namespace MiniMC
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef _TESTS_PROGRAMBUILDER__
+#define _TESTS_PROGRAMBUILDER__
+
+#include "cpa/compound.hpp"
+#include "cpa/concrete.hpp"
+#include "cpa/location.hpp"
+#include "model/cfg.hpp"
+#include "model/instructions.hpp"
+
+#include <string>
+#include <vector>
+
+namespace MiniMC {
+  namespace Tests {
+
+	/**
+	 * The CPA of the concrete searches
+	 */
+	using LocationConcrete = MiniMC::CPA::Compounds::Compound<1,MiniMC::CPA::Location::CPA,MiniMC::CPA::Concrete::CPA>;
+
+	/**
+	 * A function under construction. The first location made is the
+	 * initial one.
+	 */
+	struct FunctionBuilder {
+	  FunctionBuilder (const MiniMC::Model::Program_ptr& prgm, const std::string& name) : name(name),
+																						  cfg(prgm->makeCFG ()),
+																						  stack(prgm->makeVariableStack (name)),
+																						  creator(name),
+																						  source(std::make_shared<MiniMC::Model::SourceInfo> ()) {}
+
+	  MiniMC::Model::Location_ptr location (const std::string& lname, MiniMC::Model::AttrType attrs = 0) {
+		auto loc = cfg->makeLocation (creator.make (lname,attrs,*source));
+		if (!initial) {
+		  cfg->setInitial (loc);
+		  initial = true;
+		}
+		return loc;
+	  }
+
+	  MiniMC::Model::Edge_ptr edge (const MiniMC::Model::Location_ptr& from, const MiniMC::Model::Location_ptr& to, const std::vector<MiniMC::Model::Instruction>& instr = {}) {
+		auto edge = cfg->makeEdge (from,to);
+		if (instr.size ())
+		  edge->setAttribute<MiniMC::Model::AttributeType::Instructions> (MiniMC::Model::InstructionStream (instr));
+		return edge;
+	  }
+
+	  MiniMC::Model::Variable_ptr local (const std::string& vname, const MiniMC::Model::Type_ptr& type) {
+		return stack->addVariable (vname,type);
+	  }
+
+	  std::string name;
+	  MiniMC::Model::CFG_ptr cfg;
+	  MiniMC::Model::VariableStackDescr_ptr stack;
+	  MiniMC::Model::LocationInfoCreator creator;
+	  std::shared_ptr<MiniMC::Model::SourceInfo> source;
+	  bool initial = false;
+	};
+
+	/**
+	 * Program built in code for the tests, with 64 bit types and
+	 * constants
+	 */
+	struct ProgramBuilder {
+	  ProgramBuilder () : prgm(std::make_shared<MiniMC::Model::Program> (std::make_shared<MiniMC::Model::TypeFactory64> (),
+																		std::make_shared<MiniMC::Model::ConstantFactory64> ())),
+						  int64(prgm->getTypeFactory ()->makeIntegerType (64)) {}
+
+	  MiniMC::Model::Variable_ptr global (const std::string& name, const MiniMC::Model::Type_ptr& type) {
+		auto var = prgm->getGlobals ()->addVariable (name,type);
+		var->setGlobal ();
+		return var;
+	  }
+
+	  FunctionBuilder function (const std::string& name) {
+		return FunctionBuilder (prgm,name);
+	  }
+
+	  /**
+	   * Add \p func to the program and start \p processes processes
+	   * running it
+	   */
+	  void start (const FunctionBuilder& func, std::size_t processes = 1) {
+		prgm->addFunction (func.name,{},prgm->getTypeFactory ()->makeVoidType (),func.stack,func.cfg);
+		for (std::size_t i = 0; i < processes; ++i)
+		  prgm->addEntryPoint (func.name);
+	  }
+
+	  /**
+	   * @return the instruction \p res = \p left + \p step
+	   */
+	  MiniMC::Model::Instruction add (const MiniMC::Model::Variable_ptr& res, const MiniMC::Model::Variable_ptr& left, MiniMC::uint64_t step) {
+		return MiniMC::Model::InstBuilder<MiniMC::Model::InstructionCode::Add> {}.setRes (res).setLeft (left).setRight (prgm->getConstantFactory ()->makeIntegerConstant (step,int64)).BuildInstruction ();
+	  }
+
+	  MiniMC::Model::Program_ptr prgm;
+	  MiniMC::Model::Type_ptr int64;
+	};
+
+	/**
+	 * A single process looping on one location whose self loop does
+	 * x = x + 1, so the state space never ends
+	 */
+	struct Counter : public ProgramBuilder {
+	  Counter () {
+		auto main = function ("main");
+		x = main.local ("x",int64);
+		auto loc = main.location ("loop");
+		edge = main.edge (loc,loc,{add (x,x,1)});
+		start (main);
+	  }
+
+	  MiniMC::Model::Variable_ptr x;
+	  MiniMC::Model::Edge_ptr edge;
+	};
+
+  } // namespace Tests
+} // namespace MiniMC
+
+#endif
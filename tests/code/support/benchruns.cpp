@@ -0,0 +1,68 @@
+#include "algorithms/telemetry.hpp"
+#include "gtest/gtest.h"
+#include "support/benchruns.hpp"
+
+#include <sstream>
+
+// Run alone would name testing::Test::Run inside the tests
+using Runs = std::vector<MiniMC::Support::Bench::Run>;
+
+Runs runs (const std::string& result, double wall, std::size_t peakRSS) {
+  return {{.config = "a.ini", .run = 0, .result = result, .states = 10, .wall = wall, .peakRSS = peakRSS},
+		  {.config = "a.ini", .run = 1, .result = result, .states = 10, .wall = wall * 3, .peakRSS = peakRSS / 2},
+		  {.config = "a.ini", .run = 2, .result = result, .states = 10, .wall = wall / 3, .peakRSS = peakRSS / 2}};
+}
+
+TEST(benchruns, csvRoundtrip) {
+  Runs written {{.config = "dir/with, comma.ini", .variant = "--cpa=2 \"quoted\"", .run = 3, .result = "NotFound", .states = 1234, .wall = 1.5, .peakRSS = 4096},
+							{.config = "b.ini", .run = 0, .result = "Signal9", .states = 0, .wall = 0.25, .peakRSS = 10}};
+  std::stringstream str;
+  MiniMC::Support::Bench::writeCSV (str,written);
+  auto read = MiniMC::Support::Bench::readCSV (str);
+  ASSERT_EQ (read.size (),written.size ());
+  for (std::size_t i = 0; i < read.size (); ++i) {
+	EXPECT_EQ (read[i].config,written[i].config);
+	EXPECT_EQ (read[i].variant,written[i].variant);
+	EXPECT_EQ (read[i].run,written[i].run);
+	EXPECT_EQ (read[i].result,written[i].result);
+	EXPECT_EQ (read[i].states,written[i].states);
+	EXPECT_DOUBLE_EQ (read[i].wall,written[i].wall);
+	EXPECT_EQ (read[i].peakRSS,written[i].peakRSS);
+  }
+}
+
+TEST(benchruns, resultAndStatesFromStatistics) {
+  std::stringstream json;
+  MiniMC::Algorithms::writeSample (json,{.explored = 42},"Found");
+  EXPECT_EQ (MiniMC::Support::Bench::readString (json.str (),"result"),"Found");
+  EXPECT_EQ (MiniMC::Support::Bench::readStatistic (json.str (),"explored"),42);
+
+  std::stringstream noResult;
+  MiniMC::Algorithms::writeSample (noResult,{.explored = 42});
+  EXPECT_EQ (MiniMC::Support::Bench::readString (noResult.str (),"result"),"");
+}
+
+TEST(benchruns, compareUsesMedianAgainstThreshold) {
+  auto& mess = MiniMC::Support::getMessager ();
+  auto base = runs ("NotFound",1.0,1000);
+  EXPECT_EQ (MiniMC::Support::Bench::compare (runs ("NotFound",1.0,1000),base,0.1,mess),0);
+  // Within the threshold
+  EXPECT_EQ (MiniMC::Support::Bench::compare (runs ("NotFound",1.09,1099),base,0.1,mess),0);
+  // Median wall time and peak memory both beyond it
+  EXPECT_EQ (MiniMC::Support::Bench::compare (runs ("NotFound",1.2,1200),base,0.1,mess),2);
+  EXPECT_EQ (MiniMC::Support::Bench::compare (runs ("NotFound",1.2,1200),base,0.5,mess),0);
+  // A single slow run does not move the median
+  auto outlier = base;
+  outlier[1].wall = 100;
+  EXPECT_EQ (MiniMC::Support::Bench::compare (outlier,base,0.1,mess),0);
+}
+
+TEST(benchruns, changedResultIsRegression) {
+  auto& mess = MiniMC::Support::getMessager ();
+  auto base = runs ("NotFound",1.0,1000);
+  EXPECT_EQ (MiniMC::Support::Bench::compare (runs ("Found",1.0,1000),base,0.1,mess),1);
+  auto other = runs ("Found",1.0,1000);
+  for (auto& r : other)
+	r.config = "b.ini";
+  EXPECT_EQ (MiniMC::Support::Bench::compare (other,base,0.1,mess),0);
+}
@@ -0,0 +1,34 @@
+#include "support/random.hpp"
+#include "gtest/gtest.h"
+
+TEST(splitmix, sameStreamSameNumbers) {
+  MiniMC::Support::SplitMix64 a (42,7);
+  MiniMC::Support::SplitMix64 b (42,7);
+  for (int i = 0; i < 100; ++i)
+	EXPECT_EQ (a (),b ());
+}
+
+TEST(splitmix, streamsDiffer) {
+  MiniMC::Support::SplitMix64 a (42,0);
+  MiniMC::Support::SplitMix64 b (42,1);
+  MiniMC::Support::SplitMix64 c (43,0);
+  auto first = a ();
+  EXPECT_NE (first,b ());
+  EXPECT_NE (first,c ());
+}
+
+TEST(randomnumber, selectStreamIsReproducible) {
+  MiniMC::Support::setSeed (1234);
+  MiniMC::Support::RandomNumber<> random;
+  std::vector<std::uint32_t> first;
+  MiniMC::Support::RandomNumber<>::selectStream (5);
+  for (int i = 0; i < 10; ++i)
+	first.push_back (random.uniform<std::uint32_t> (0,1000));
+  
+  MiniMC::Support::RandomNumber<>::selectStream (6);
+  random.uniform<std::uint32_t> ();
+  
+  MiniMC::Support::RandomNumber<>::selectStream (5);
+  for (int i = 0; i < 10; ++i)
+	EXPECT_EQ (first[i],random.uniform<std::uint32_t> (0,1000));
+}
@@ -0,0 +1,46 @@
+#include "support/timing.hpp"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+
+TEST(Timer, accumulatesStoppedIntervals) {
+  MiniMC::Support::Timer timer ("test");
+  for (int i = 0; i < 2; ++i) {
+	timer.startTimer ();
+	std::this_thread::sleep_for (std::chrono::milliseconds (5));
+	timer.stopTimer ();
+  }
+  EXPECT_GE (timer.total ().milliseconds,10);
+}
+
+TEST(Profiler, recordsNestedPhasesPerThread) {
+  auto& profiler = MiniMC::Support::Profiler::get ();
+  {
+	// Nothing is recorded before the profiler is enabled
+	MiniMC::Support::Phase phase ("Disabled");
+  }
+  profiler.enable (true);
+  {
+	MiniMC::Support::Phase outer ("Outer");
+	for (int i = 0; i < 3; ++i) {
+	  MiniMC::Support::Phase inner ("Inner");
+	}
+	std::thread worker ([]() {MiniMC::Support::Phase phase ("Worker");});
+	worker.join ();
+  }
+
+  auto phases = profiler.getPhases ();
+  EXPECT_EQ (phases.count ("Disabled"),0);
+  EXPECT_EQ (phases["Outer"].calls,1);
+  EXPECT_EQ (phases["Outer/Inner"].calls,3);
+  EXPECT_EQ (phases["Worker"].calls,1);
+  EXPECT_GE (phases["Outer"].wall,phases["Outer/Inner"].wall);
+
+  std::stringstream json;
+  profiler.writeJSON (json);
+  EXPECT_NE (json.str ().find ("\"phase\": \"Outer/Inner\", \"calls\": 3"),std::string::npos);
+  std::stringstream trace;
+  profiler.writeTrace (trace);
+  EXPECT_NE (trace.str ().find ("\"name\": \"Inner\", \"ph\": \"X\""),std::string::npos);
+}
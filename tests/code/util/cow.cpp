@@ -0,0 +1,31 @@
+#include "gtest/gtest.h"
+#include "util/cow.hpp"
+
+#include <vector>
+
+TEST(cow, copiesShare)
+{
+  MiniMC::Util::CopyOnWrite<std::vector<int>> a (std::vector<int>{1,2,3});
+  auto b = a;
+  EXPECT_TRUE (a.shares (b));
+  EXPECT_EQ (&a.get (),&b.get ());
+}
+
+TEST(cow, modifyDetaches)
+{
+  MiniMC::Util::CopyOnWrite<std::vector<int>> a (std::vector<int>{1,2,3});
+  auto b = a;
+  b.modify ()[0] = 5;
+  EXPECT_FALSE (a.shares (b));
+  EXPECT_EQ (a.get ()[0],1);
+  EXPECT_EQ (b.get ()[0],5);
+  EXPECT_NE (a,b);
+}
+
+TEST(cow, soleOwnerModifiesInPlace)
+{
+  MiniMC::Util::CopyOnWrite<std::vector<int>> a (std::vector<int>{1,2,3});
+  auto* before = &a.get ();
+  a.modify ()[0] = 5;
+  EXPECT_EQ (before,&a.get ());
+}